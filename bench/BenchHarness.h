@@ -0,0 +1,270 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// Small benchmark runner for bench_blackjack. Each case times run(iters),
+// which must perform `iters` operations and return something derived from
+// their results so the optimizer cannot drop them.
+//
+// Per case: iterations are calibrated until one repetition takes at least
+// minSeconds, then `warmup` repetitions are run and thrown away, then `reps`
+// timed repetitions are kept. The median ns/op is the headline figure and
+// the one compared against a baseline.
+//
+// runPair() instead measures what one case costs over another: it alternates
+// their repetitions so drift on a shared machine lands on both alike, and
+// reports the median of the per-round ratios alongside the ratio of the
+// fastest repetitions. Either resolves a percent or two where comparing two
+// separate runAll() medians cannot.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Case results end up here so the work behind them counts as observable
+inline volatile uint64_t benchSink = 0;
+
+struct BenchCase {
+    std::string name;
+    std::string unit;                             // What one operation is ("card", "hand", ...)
+    std::function<void(long long iters)> setup;   // Optional, untimed, runs before every repetition
+    std::function<uint64_t(long long iters)> run;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string unit;
+    long long iters = 0;
+    double medianNs = 0;
+    double minNs = 0;
+    double meanNs = 0;
+    double stddevNs = 0;
+    double baselineNs = 0; // 0 when no baseline entry exists
+    double opsPerSecond() const { return medianNs > 0 ? 1e9 / medianNs : 0; }
+    double changePercent() const { return baselineNs > 0 ? (medianNs / baselineNs - 1) * 100 : 0; }
+};
+
+struct BenchOptions {
+    int warmup = 2;
+    int reps = 10;
+    double minSeconds = 0.05;
+    std::string filter;       // Only cases whose name contains this
+    std::string jsonFile;
+    std::string csvFile;
+    std::string baselineFile;
+    double threshold = 10;    // Percent slowdown against the baseline that counts as a regression
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& options) : options(options) {}
+
+    void add(BenchCase c) { cases.push_back(std::move(c)); }
+
+    static bool isOptimized() {
+#ifdef __OPTIMIZE__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Times cases `base` and `other` in alternating repetitions at the same iteration
+    // count and prints each one's min and median ns/op and other's overhead over base.
+    // Many short rounds (a small --min-time, a large --reps) resolve it best.
+    // False if either case does not exist.
+    bool runPair(const std::string& base, const std::string& other) {
+        BenchCase* a = find(base);
+        BenchCase* b = find(other);
+        if (!a || !b) {
+            std::cerr << "No benchmark named " << (a ? other : base) << std::endl;
+            return false;
+        }
+        uint64_t sink = 0;
+        long long iters = calibrate(*a, sink);
+        for (int i = 0; i < options.warmup; ++i) {
+            timeOnce(*a, iters, sink);
+            timeOnce(*b, iters, sink);
+        }
+        std::vector<double> nsA, nsB, ratios;
+        for (int i = 0; i < std::max(1, options.reps); ++i) {
+            // Swap the order every round so neither case always runs on a warmer cache
+            bool aFirst = i % 2 == 0;
+            double first = timeOnce(aFirst ? *a : *b, iters, sink) * 1e9 / iters;
+            double second = timeOnce(aFirst ? *b : *a, iters, sink) * 1e9 / iters;
+            nsA.push_back(aFirst ? first : second);
+            nsB.push_back(aFirst ? second : first);
+            ratios.push_back(nsB.back() / nsA.back());
+        }
+        std::sort(nsA.begin(), nsA.end());
+        std::sort(nsB.begin(), nsB.end());
+        std::sort(ratios.begin(), ratios.end());
+        benchSink = benchSink + sink;
+
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(12) << "min ns/op"
+                  << std::setw(14) << "median ns/op" << std::endl;
+        for (int k = 0; k < 2; ++k) {
+            const std::vector<double>& ns = k == 0 ? nsA : nsB;
+            std::cout << std::left << std::setw(28) << (k == 0 ? base : other) << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << ns.front() << std::setw(14) << ns[ns.size() / 2]
+                      << std::endl;
+        }
+        std::cout << std::setprecision(2) << std::showpos << "Overhead of " << other << ": "
+                  << (ratios[ratios.size() / 2] - 1) * 100 << "% (median of paired rounds), "
+                  << (nsB.front() / nsA.front() - 1) * 100 << "% (min) over " << std::noshowpos << ratios.size()
+                  << " rounds of " << iters << " " << a->unit << "s" << std::endl;
+        return true;
+    }
+
+    // Runs every selected case; returns the number of regressions against the baseline
+    int runAll() {
+        std::map<std::string, double> baseline = loadBaseline(options.baselineFile);
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(12) << "ns/op"
+                  << std::setw(10) << "+/-%" << std::setw(16) << "ops/sec"
+                  << (baseline.empty() ? "" : "    vs baseline") << std::endl;
+
+        int regressions = 0;
+        for (auto& c : cases) {
+            if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) continue;
+            BenchResult r = measure(c);
+            auto it = baseline.find(r.name);
+            if (it != baseline.end()) r.baselineNs = it->second;
+            bool regressed = r.baselineNs > 0 && r.changePercent() > options.threshold;
+            regressions += regressed ? 1 : 0;
+
+            std::cout << std::left << std::setw(28) << r.name << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << r.medianNs << std::setw(10)
+                      << (r.medianNs > 0 ? r.stddevNs / r.meanNs * 100 : 0) << std::setw(16)
+                      << std::setprecision(0) << r.opsPerSecond();
+            if (r.baselineNs > 0) {
+                std::cout << std::setprecision(1) << std::setw(10) << std::showpos << r.changePercent()
+                          << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "");
+            }
+            std::cout << std::endl;
+            results.push_back(r);
+        }
+
+        if (!options.jsonFile.empty()) writeJson(options.jsonFile);
+        if (!options.csvFile.empty()) writeCsv(options.csvFile);
+        return regressions;
+    }
+
+private:
+    BenchOptions options;
+    std::vector<BenchCase> cases;
+    std::vector<BenchResult> results;
+
+    double timeOnce(BenchCase& c, long long iters, uint64_t& sink) {
+        if (c.setup) c.setup(iters);
+        auto start = std::chrono::steady_clock::now();
+        sink += c.run(iters);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    BenchCase* find(const std::string& name) {
+        for (auto& c : cases) {
+            if (c.name == name) return &c;
+        }
+        return nullptr;
+    }
+
+    // Iterations for one repetition to take at least minSeconds
+    long long calibrate(BenchCase& c, uint64_t& sink) {
+        long long iters = 1;
+        for (;;) {
+            double seconds = timeOnce(c, iters, sink);
+            if (seconds >= options.minSeconds || iters >= (1LL << 40)) return iters;
+            // Aim straight for the target once the timing is meaningful
+            double factor = seconds > 1e-4 ? options.minSeconds / seconds * 1.2 : 10;
+            iters = static_cast<long long>(iters * std::min(10.0, std::max(factor, 1.5)));
+        }
+    }
+
+    BenchResult measure(BenchCase& c) {
+        uint64_t sink = 0;
+        long long iters = calibrate(c, sink);
+        for (int i = 0; i < options.warmup; ++i) timeOnce(c, iters, sink);
+
+        std::vector<double> ns;
+        for (int i = 0; i < std::max(1, options.reps); ++i) ns.push_back(timeOnce(c, iters, sink) * 1e9 / iters);
+        std::sort(ns.begin(), ns.end());
+
+        BenchResult r;
+        r.name = c.name;
+        r.unit = c.unit;
+        r.iters = iters;
+        r.minNs = ns.front();
+        size_t mid = ns.size() / 2;
+        r.medianNs = (ns.size() % 2) ? ns[mid] : (ns[mid - 1] + ns[mid]) / 2;
+        for (double v : ns) r.meanNs += v;
+        r.meanNs /= ns.size();
+        for (double v : ns) r.stddevNs += (v - r.meanNs) * (v - r.meanNs);
+        r.stddevNs = ns.size() > 1 ? std::sqrt(r.stddevNs / (ns.size() - 1)) : 0;
+        benchSink = benchSink + sink;
+        return r;
+    }
+
+    // Reads the "name" and "median_ns" of every result line a previous --json run wrote
+    static std::map<std::string, double> loadBaseline(const std::string& file) {
+        std::map<std::string, double> baseline;
+        if (file.empty()) return baseline;
+        std::ifstream in(file);
+        if (!in) {
+            std::cerr << "Could not read baseline " << file << std::endl;
+            return baseline;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t name = line.find("\"name\": \"");
+            size_t median = line.find("\"median_ns\": ");
+            if (name == std::string::npos || median == std::string::npos) continue;
+            name += 9;
+            baseline[line.substr(name, line.find('"', name) - name)] = std::stod(line.substr(median + 13));
+        }
+        return baseline;
+    }
+
+    void writeJson(const std::string& file) const {
+        std::ofstream out(file);
+        if (!out) {
+            std::cerr << "Could not write " << file << std::endl;
+            return;
+        }
+        out << std::setprecision(6);
+        out << "{\n  \"warmup\": " << options.warmup << ",\n  \"reps\": " << options.reps
+            << ",\n  \"optimized\": " << (isOptimized() ? "true" : "false") << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            // One result per line; loadBaseline relies on it
+            out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"iters\": " << r.iters
+                << ", \"median_ns\": " << r.medianNs << ", \"min_ns\": " << r.minNs << ", \"mean_ns\": " << r.meanNs
+                << ", \"stddev_ns\": " << r.stddevNs << ", \"ops_per_sec\": " << r.opsPerSecond() << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}" << std::endl;
+    }
+
+    void writeCsv(const std::string& file) const {
+        std::ofstream out(file);
+        if (!out) {
+            std::cerr << "Could not write " << file << std::endl;
+            return;
+        }
+        out << std::setprecision(6);
+        out << "name,unit,iters,median_ns,min_ns,mean_ns,stddev_ns,ops_per_sec,baseline_ns\n";
+        for (const auto& r : results) {
+            out << r.name << "," << r.unit << "," << r.iters << "," << r.medianNs << "," << r.minNs << ","
+                << r.meanNs << "," << r.stddevNs << "," << r.opsPerSecond() << "," << r.baselineNs << "\n";
+        }
+    }
+};
+
+#endif
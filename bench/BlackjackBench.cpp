@@ -0,0 +1,438 @@
+// Micro and macro benchmarks for the simulation and learning hot paths.
+//
+//   bench_blackjack [--reps N] [--warmup N] [--min-time S] [--filter TEXT]
+//                   [--json FILE] [--csv FILE] [--baseline FILE] [--threshold PCT]
+//   bench_blackjack --pair BASE OTHER [--reps N] [--warmup N] [--min-time S]
+//
+// Save a release's numbers with --json, then pass that file back as
+// --baseline to a later build: any case whose median is more than
+// --threshold percent slower is flagged and the exit code is non-zero.
+// --pair runs just two cases in alternation and prints OTHER's overhead over BASE.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BenchHarness.h"
+#include "BatchSimulator.h"
+#include "CountLearner.h"
+#include "Deck.h"
+#include "Hand.h"
+#include "HandHistory.h"
+#include "LearnerAlgorithms.h"
+#include "QLearner.h"
+#include "QTableFile.h"
+#include "QTableStore.h"
+#include "ReplayBuffer.h"
+#include "Random.h"
+#include "RuleSet.h"
+#include "Shoe.h"
+#include "TableSimulator.h"
+#include "TileLearner.h"
+#include "Telemetry.h"
+#include "Trainer.h"
+
+namespace {
+
+// Silences std::cout while QLearner's database calls print their messages
+class QuietCout {
+public:
+    QuietCout() : old(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietCout() { std::cout.rdbuf(old); }
+
+private:
+    std::ostringstream sink;
+    std::streambuf* old;
+};
+
+// Trainers print through TrainerConfig::log, so they are silenced through their config
+TrainerConfig quietConfig() {
+    TrainerConfig config;
+    config.log = nullptr;
+    return config;
+}
+
+// A table with a value in every state the trainer reaches, so lookups look like a trained run
+QLearner makeTrainedLearner() {
+    QLearner ai;
+    Rng rng = streamRng(1000);
+    for (int total = 0; total < QTable::TOTALS; ++total) {
+        for (int dealer = 2; dealer <= 11; ++dealer) {
+            double* q = ai.qTable[State{total, dealer, false}];
+            q[0] = rng.uniform() * 2 - 1;
+            q[1] = rng.uniform() * 2 - 1;
+        }
+    }
+    return ai;
+}
+
+std::vector<State> makeStates(int count) {
+    Rng rng = streamRng(1001);
+    std::vector<State> states(count);
+    for (auto& s : states) s = State{4 + static_cast<int>(rng.below(18)), 2 + static_cast<int>(rng.below(10)), false};
+    return states;
+}
+
+void addDeckCases(BenchRunner& bench) {
+    auto deck = std::make_shared<Deck>();
+    bench.add({"deck_shuffle", "shuffle", nullptr, [deck](long long iters) {
+        for (long long i = 0; i < iters; ++i) deck->shuffle();
+        return static_cast<uint64_t>(deck->dealCard().getId());
+    }});
+
+    // Deck throws once its 52 cards are gone, so every repetition starts from fresh decks
+    auto decks = std::make_shared<std::vector<Deck>>();
+    bench.add({"deck_deal", "card",
+        [decks](long long iters) { decks->assign(static_cast<size_t>(iters / 52 + 1), Deck()); },
+        [decks](long long iters) {
+            uint64_t sum = 0;
+            for (long long i = 0; i < iters; ++i) sum += (*decks)[i / 52].dealCard().getId();
+            return sum;
+        }});
+
+    auto shoe = std::make_shared<Shoe>(6, 0.75, false, streamRng(1002));
+    bench.add({"shoe_deal", "card", nullptr, [shoe](long long iters) {
+        uint64_t sum = 0;
+        for (long long i = 0; i < iters; ++i) {
+            shoe->prepareRound();
+            sum += shoe->dealCard().getValue();
+        }
+        return sum;
+    }});
+}
+
+void addHandCases(BenchRunner& bench) {
+    // 1024 hands of 2-6 cards, soft and hard, read round-robin
+    auto hands = std::make_shared<std::vector<Hand>>(1024);
+    Rng rng = streamRng(1003);
+    for (auto& hand : *hands) {
+        int cards = 2 + static_cast<int>(rng.below(5));
+        for (int c = 0; c < cards; ++c) hand.addCard(Card::fromId(static_cast<int>(rng.below(52))));
+    }
+    bench.add({"hand_get_total", "hand", nullptr, [hands](long long iters) {
+        uint64_t sum = 0;
+        for (long long i = 0; i < iters; ++i) sum += (*hands)[i & 1023].getTotal();
+        return sum;
+    }});
+}
+
+void addLearnerCases(BenchRunner& bench) {
+    auto ai = std::make_shared<QLearner>(makeTrainedLearner());
+    auto states = std::make_shared<std::vector<State>>(makeStates(4096));
+
+    bench.add({"qlearner_decide_greedy", "decision", nullptr, [ai, states](long long iters) {
+        uint64_t sum = 0;
+        for (long long i = 0; i < iters; ++i) sum += ai->decide((*states)[i & 4095], false);
+        return sum;
+    }});
+    bench.add({"qlearner_decide_explore", "decision", nullptr, [ai, states](long long iters) {
+        uint64_t sum = 0;
+        for (long long i = 0; i < iters; ++i) sum += ai->decide((*states)[i & 4095], true);
+        return sum;
+    }});
+    bench.add({"qlearner_update", "update", nullptr, [ai, states](long long iters) {
+        for (long long i = 0; i < iters; ++i) {
+            const State& s = (*states)[i & 4095];
+            State next{std::min(s.pTotal + 5, 31), s.dCard, false};
+            ai->update(s, static_cast<int>(i & 1), (i % 3) - 1.0, next, next.pTotal > 21);
+        }
+        return static_cast<uint64_t>(ai->qTable.at((*states)[0])[0] * 1e6);
+    }});
+}
+
+// Tile-coded Q values: 16 hashed cells and their weights per state, AVX2 and scalar
+void addTileCases(BenchRunner& bench) {
+    auto ai = std::make_shared<TileLearner>();
+    Rng rng = streamRng(1002);
+    for (auto& w : ai->weights) w = static_cast<float>(rng.uniform() * 2 - 1);
+    auto states = std::make_shared<std::vector<CountState>>();
+    for (const State& s : makeStates(4096)) {
+        states->push_back(CountState{s.pTotal, s.dCard, false, static_cast<int>(rng.below(CountQTable::COUNT_BUCKETS))});
+    }
+
+    for (bool avx2 : {true, false}) {
+        if (avx2 && !TileCoder(ai->coder.getBits()).usingAvx2()) continue;
+        bench.add({avx2 ? "tile_q_values" : "tile_q_values_scalar", "state", nullptr, [ai, states, avx2](long long iters) {
+            ai->coder.setUseAvx2(avx2);
+            double sum = 0;
+            for (long long i = 0; i < iters; ++i) {
+                double q[2];
+                ai->qValues((*states)[i & 4095], q);
+                sum += q[0] + q[1];
+            }
+            ai->coder.setUseAvx2(true);
+            return static_cast<uint64_t>(std::abs(sum));
+        }});
+    }
+    bench.add({"tile_update", "update", nullptr, [ai, states](long long iters) {
+        for (long long i = 0; i < iters; ++i) {
+            const CountState& s = (*states)[i & 4095];
+            CountState next{std::min(s.pTotal + 5, 31), s.dCard, false, s.countBucket};
+            ai->update(s, static_cast<int>(i & 1), (i % 3) - 1.0, next, next.pTotal > 21);
+        }
+        return static_cast<uint64_t>(ai->weights[0] * 1e6);
+    }});
+}
+
+// One operation is one replayed transition: sampling, gathering and the batched update
+void addReplayCases(BenchRunner& bench) {
+    auto fill = [](ReplayBuffer& buffer) {
+        auto states = makeStates(1 << 16);
+        Rng rng = streamRng(1004);
+        for (size_t i = 0; i < buffer.capacity(); ++i) {
+            const State& s = states[i & 0xFFFF];
+            State next{s.pTotal + 1 + static_cast<int>(rng.below(10)), s.dCard, false};
+            buffer.add(makeTransition(s, static_cast<int>(rng.below(2)), 0, next, next.pTotal > 21));
+        }
+    };
+    auto ai = std::make_shared<QLearner>(makeTrainedLearner());
+    auto uniform = std::make_shared<ReplayBuffer>(1 << 20, ReplaySampling::Uniform);
+    auto prioritized = std::make_shared<ReplayBuffer>(1 << 20, ReplaySampling::Prioritized);
+    fill(*uniform);
+    fill(*prioritized);
+
+    bench.add({"replay_uniform", "transition", nullptr, [ai, uniform](long long iters) {
+        ReplayBatch batch;
+        for (long long done = 0; done < iters; done += 32) replayBatch(*ai, *uniform, batch, 32, 0.005);
+        return static_cast<uint64_t>(batch.slots.empty() ? 0 : batch.slots[0]);
+    }});
+    bench.add({"replay_prioritized", "transition", nullptr, [ai, prioritized](long long iters) {
+        ReplayBatch batch;
+        for (long long done = 0; done < iters; done += 32) replayBatch(*ai, *prioritized, batch, 32, 0.005);
+        return static_cast<uint64_t>(batch.slots.empty() ? 0 : batch.slots[0]);
+    }});
+}
+
+void addDatabaseCases(BenchRunner& bench) {
+    std::string file = "bench_blackjack.db";
+    auto ai = std::make_shared<QLearner>(makeTrainedLearner());
+    {
+        QuietCout quiet;
+        ai->saveToDatabase(file);
+    }
+
+    bench.add({"db_save", "save", nullptr, [ai, file](long long iters) {
+        QuietCout quiet;
+        for (long long i = 0; i < iters; ++i) ai->saveToDatabase(file);
+        return static_cast<uint64_t>(ai->qTable.size());
+    }});
+    // What a training checkpoint costs: a long-lived store writing the ~20 states one hand touches
+    auto store = std::make_shared<QTableStore>(file);
+    bench.add({"db_save_dirty", "save", nullptr, [ai, store](long long iters) {
+        uint64_t rows = 0;
+        for (long long i = 0; i < iters; ++i) {
+            for (int s = 0; s < 20; ++s) ai->qTable[State{4 + (s + static_cast<int>(i)) % 18, 2 + s % 10, false}][0] += 1e-9;
+            store->saveDirty(ai->qTable);
+            rows += store->lastSaveRows();
+        }
+        return rows;
+    }});
+    bench.add({"db_load", "load", nullptr, [file](long long iters) {
+        QuietCout quiet;
+        QLearner loaded;
+        for (long long i = 0; i < iters; ++i) loaded.loadFromDatabase(file);
+        return static_cast<uint64_t>(loaded.qTable.size());
+    }});
+
+    std::string binary = "bench_blackjack.bqt";
+    writeQTableFile(binary, ai->qTable);
+    bench.add({"table_file_map", "load", nullptr, [binary](long long iters) {
+        uint64_t sum = 0;
+        for (long long i = 0; i < iters; ++i) {
+            MappedQTable mapped(binary);
+            sum += mapped.decide(State{16, 10, false});
+        }
+        return sum;
+    }});
+}
+
+void addHistoryCases(BenchRunner& bench) {
+    // A few thousand real training hands, re-encoded over and over
+    auto hands = std::make_shared<std::vector<std::pair<Hand, Hand>>>();
+    Shoe shoe(6, 0.75, false, streamRng(1003));
+    for (int i = 0; i < 4096; ++i) {
+        shoe.prepareRound();
+        Hand player, dealer;
+        player.addCard(shoe.dealCard());
+        dealer.addCard(shoe.dealCard());
+        player.addCard(shoe.dealCard());
+        dealer.addCard(shoe.dealCard());
+        while (player.getTotal() < 15) player.addCard(shoe.dealCard());
+        while (!player.isBust() && dealer.getTotal() < 17) dealer.addCard(shoe.dealCard());
+        hands->emplace_back(player, dealer);
+    }
+
+    bench.add({"history_record", "hand", nullptr, [hands](long long iters) {
+        HandHistoryBlock block;
+        uint64_t bytes = 0;
+        for (long long i = 0; i < iters; ++i) {
+            const auto& h = (*hands)[i & 4095];
+            block.record(h.first, h.second, settleHand(h.first, h.second), false);
+            if (block.size() >= HandHistoryWriter::BLOCK_BYTES) {
+                bytes += block.size();
+                block.clear();
+            }
+        }
+        return bytes + block.size();
+    }});
+
+    std::string file = "bench_blackjack.bjh";
+    {
+        HandHistoryWriter writer(file);
+        writer.beginSession(HistorySource::Training, 42, 6, RuleSet());
+        for (int i = 0; i < 256; ++i) {
+            for (const auto& h : *hands) writer.record(h.first, h.second, settleHand(h.first, h.second), false);
+        }
+    }
+    // One operation is one hand decoded from the mapping; the file is reopened every ~1M hands
+    bench.add({"history_scan", "hand", nullptr, [file](long long iters) {
+        uint64_t wins = 0;
+        HandRecord hand;
+        for (long long done = 0; done < iters;) {
+            HandHistoryReader reader(file);
+            while (done < iters && reader.next(hand)) {
+                wins += hand.outcome == HandOutcome::Win;
+                ++done;
+            }
+        }
+        return wins;
+    }});
+}
+
+// End-to-end throughput: one operation is one hand played and learned from
+void addMacroCases(BenchRunner& bench) {
+    auto ai = std::make_shared<QLearner>();
+    bench.add({"trainer_episodes", "hand", nullptr, [ai](long long iters) {
+        runSilentTrainer(*ai, iters, quietConfig());
+        return static_cast<uint64_t>(ai->qTable.size());
+    }});
+
+    // trainer_episodes with a sample every 10000 hands; the gap between the two is the telemetry's cost
+    auto metered = std::make_shared<QLearner>();
+    auto telemetry = std::make_shared<TelemetryWriter>("bench_blackjack.telemetry.csv");
+    bench.add({"trainer_episodes_telemetry", "hand", nullptr, [metered, telemetry](long long iters) {
+        TrainerConfig config = quietConfig();
+        config.telemetry = telemetry.get();
+        runSilentTrainer(*metered, iters, config);
+        return static_cast<uint64_t>(metered->qTable.size());
+    }});
+
+    // The same loop instantiated over each other learner algorithm (trainer_episodes is Q-learning);
+    // BlackjackCLI --algorithms N compares the EV they converge to
+    for (LearnerAlgorithm algorithm : {LearnerAlgorithm::Sarsa, LearnerAlgorithm::ExpectedSarsa,
+                                       LearnerAlgorithm::DoubleQ, LearnerAlgorithm::MonteCarlo}) {
+        auto learner = std::make_shared<QLearner>();
+        std::string name = std::string("trainer_") + algorithmName(algorithm);
+        std::replace(name.begin(), name.end(), '-', '_');
+        bench.add({name, "hand", nullptr, [learner, algorithm](long long iters) {
+            TrainerConfig config = quietConfig();
+            config.algorithm = algorithm;
+            runSilentTrainer(*learner, iters, config);
+            return static_cast<uint64_t>(learner->qTable.size());
+        }});
+    }
+
+    // trainer_episodes under H17, 3:2 and peek: the hand loop compiled for other house rules
+    auto downtown = std::make_shared<QLearner>();
+    bench.add({"trainer_episodes_downtown", "hand", nullptr, [downtown](long long iters) {
+        TrainerConfig config = quietConfig();
+        RuleSet::preset("downtown", config.rules);
+        runSilentTrainer(*downtown, iters, config);
+        return static_cast<uint64_t>(downtown->qTable.size());
+    }});
+
+    // Learner episodes at a table sharing the shoe and the dealer; compare with trainer_episodes
+    for (int seats : {1, 4, 7}) {
+        auto table = std::make_shared<QLearner>();
+        std::string name = "table_episodes_" + std::to_string(seats) + "_seats";
+        bench.add({name, "hand", nullptr, [table, seats](long long iters) {
+            std::vector<Seat> learners(seats);
+            for (Seat& seat : learners) seat.learner = table.get();
+            runTableTrainer(learners, iters, quietConfig());
+            return static_cast<uint64_t>(table->qTable.size());
+        }});
+    }
+
+    // The tile-coding learner on the same shoe and hand loop as the count-aware table below
+    auto tiles = std::make_shared<TileLearner>();
+    bench.add({"tile_trainer_episodes", "hand", nullptr, [tiles](long long iters) {
+        runTileTrainer(*tiles, iters, quietConfig());
+        return static_cast<uint64_t>(tiles->weights.size());
+    }});
+
+    // Same hand loop on a persistent 6-deck shoe, learning into the 11x larger count-aware table
+    auto counting = std::make_shared<CountLearner>();
+    bench.add({"count_trainer_episodes", "hand", nullptr, [counting](long long iters) {
+        runCountTrainer(*counting, iters, quietConfig());
+        return static_cast<uint64_t>(counting->qTable.size());
+    }});
+
+    auto policy = std::make_shared<QLearner>(makeTrainedLearner());
+    bench.add({"batch_simulate", "hand", nullptr, [policy](long long iters) {
+        BatchSimulator sim(policy->qTable);
+        return static_cast<uint64_t>(sim.run(iters).wins);
+    }});
+
+    bench.add({"batch_simulate_downtown", "hand", nullptr, [policy](long long iters) {
+        RuleSet rules;
+        RuleSet::preset("downtown", rules);
+        BatchSimulator sim(policy->qTable, STREAM_BATCH, 2048, rules);
+        return static_cast<uint64_t>(sim.run(iters).wins);
+    }});
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::string pairBase, pairOther;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--reps" && hasValue) options.reps = std::stoi(argv[++i]);
+        else if (arg == "--warmup" && hasValue) options.warmup = std::stoi(argv[++i]);
+        else if (arg == "--min-time" && hasValue) options.minSeconds = std::stod(argv[++i]);
+        else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--json" && hasValue) options.jsonFile = argv[++i];
+        else if (arg == "--csv" && hasValue) options.csvFile = argv[++i];
+        else if (arg == "--baseline" && hasValue) options.baselineFile = argv[++i];
+        else if (arg == "--threshold" && hasValue) options.threshold = std::stod(argv[++i]);
+        else if (arg == "--pair" && i + 2 < argc) {
+            pairBase = argv[++i];
+            pairOther = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    // Same inputs every run, so only the code under test changes between runs
+    setMasterSeed(42);
+    if (!BenchRunner::isOptimized()) {
+        std::cerr << "Warning: built without optimizations; configure with -DCMAKE_BUILD_TYPE=Release" << std::endl;
+    }
+
+    BenchRunner bench(options);
+    addDeckCases(bench);
+    addHandCases(bench);
+    addLearnerCases(bench);
+    addTileCases(bench);
+    addReplayCases(bench);
+    addDatabaseCases(bench);
+    addHistoryCases(bench);
+    addMacroCases(bench);
+
+    bool paired = pairBase.empty() || bench.runPair(pairBase, pairOther);
+    int regressions = pairBase.empty() ? bench.runAll() : 0;
+    std::remove("bench_blackjack.db");
+    std::remove("bench_blackjack.bqt");
+    std::remove("bench_blackjack.bjh");
+    std::remove("bench_blackjack.telemetry.csv");
+    if (regressions > 0) {
+        std::cerr << regressions << " benchmark(s) regressed more than " << options.threshold << "%" << std::endl;
+        return 1;
+    }
+    return paired ? 0 : 2;
+}
@@ -0,0 +1,83 @@
+// Compares the dense QTable against the std::map<State, double[2]> it replaced,
+// using the same decide/update access pattern the trainer produces.
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+#include "QLearner.h"
+
+namespace {
+
+struct MapLearner {
+    std::map<State, double[2]> qTable;
+    double alpha = 0.1;
+    double gamma = 0.9;
+
+    int decide(State s) { return (qTable[s][1] > qTable[s][0]) ? 1 : 0; }
+
+    void update(State s, int action, double reward, State nextS, bool isDone) {
+        double maxNextQ = isDone ? 0 : std::max(qTable[nextS][0], qTable[nextS][1]);
+        qTable[s][action] += alpha * (reward + gamma * maxNextQ - qTable[s][action]);
+    }
+};
+
+struct Step {
+    State s;
+    State next;
+    double reward;
+    bool done;
+};
+
+// Player totals 4-21 against dealer 2-11, the states the trainer actually visits
+std::vector<Step> makeSteps(int count) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> total(4, 21), dealer(2, 11), card(1, 10), outcome(-1, 1);
+    std::vector<Step> steps(count);
+    for (auto& step : steps) {
+        step.s = {total(rng), dealer(rng), false};
+        step.next = {std::min(step.s.pTotal + card(rng), 31), step.s.dCard, false};
+        step.done = step.next.pTotal > 21;
+        step.reward = step.done ? -1.0 : outcome(rng);
+    }
+    return steps;
+}
+
+template <typename Learner>
+double nsPerStep(Learner& ai, const std::vector<Step>& steps, int rounds, int& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& step : steps) {
+            int action = ai.decide(step.s);
+            checksum += action;
+            ai.update(step.s, action, step.reward, step.next, step.done);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(steps.size()) * rounds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = (argc > 1) ? std::stoi(argv[1]) : 200;
+    std::vector<Step> steps = makeSteps(1 << 16);
+
+    QLearner dense;
+    MapLearner tree;
+    int checksum = 0;
+
+    // Warm-up so both tables hold every state before timing
+    nsPerStep(dense, steps, 1, checksum);
+    nsPerStep(tree, steps, 1, checksum);
+
+    double denseNs = nsPerStep(dense, steps, rounds, checksum);
+    double mapNs = nsPerStep(tree, steps, rounds, checksum);
+
+    std::cout << "decide+update, " << steps.size() * rounds << " steps" << std::endl;
+    std::cout << "  std::map  : " << mapNs << " ns/step" << std::endl;
+    std::cout << "  QTable    : " << denseNs << " ns/step" << std::endl;
+    std::cout << "  speedup   : " << mapNs / denseNs << "x (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Scaling of multi-process training on one shared-memory Q-table: for 1..N
+// processes, forks that many trainers onto a fresh segment, each playing the
+// same number of hands, and reports aggregate hands/sec, speed-up over one
+// process and the exact EV of the table they leave behind.
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "PolicyGrader.h"
+#include "QLearner.h"
+#include "SharedQTable.h"
+#include "Trainer.h"
+
+namespace {
+
+// One child process: join, train its share, leave. The parent stays attached, so no child is last.
+int trainChild(const std::string& name, long long hands) {
+    SharedQTable shared;
+    if (!shared.attach(name, [](AtomicQTable&) {})) return 1;
+    QLearner ai;
+    TrainerConfig config;
+    config.log = nullptr;
+    runSharedMemoryTrainer(ai, hands, config, shared);
+    shared.detach();
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int maxProcesses = (argc > 1) ? std::stoi(argv[1]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    long long hands = (argc > 2) ? static_cast<long long>(std::stod(argv[2])) : 2000000;
+    std::string name = "/bench_shm_" + std::to_string(getpid());
+
+    std::cout << "Shared-memory training, " << hands << " hands per process, "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << std::setw(10) << "Processes" << std::setw(12) << "Hands" << std::setw(10) << "Seconds" << std::setw(14)
+              << "Hands/sec" << std::setw(10) << "Speed-up" << std::setw(12) << "Efficiency" << std::setw(10) << "EV"
+              << std::endl;
+    std::cout << std::fixed;
+
+    double single = 0;
+    for (int processes = 1; processes <= maxProcesses; ++processes) {
+        SharedQTable shared;
+        if (!shared.attach(name, [](AtomicQTable&) {})) return 1;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<pid_t> children;
+        for (int p = 0; p < processes; ++p) {
+            pid_t pid = fork();
+            if (pid == 0) _exit(trainChild(name, hands));
+            if (pid < 0) {
+                std::cerr << "fork failed" << std::endl;
+                return 1;
+            }
+            children.push_back(pid);
+        }
+        bool failed = false;
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (failed) {
+            std::cerr << "A trainer process failed" << std::endl;
+            return 1;
+        }
+
+        QTable table;
+        shared.table().storeTo(table);
+        long long total = shared.handsTrained();
+        if (shared.detach()) shared.remove();
+
+        double rate = total / elapsed.count();
+        if (processes == 1) single = rate;
+        std::cout << std::setw(10) << processes << std::setw(12) << total << std::setw(10) << std::setprecision(2)
+                  << elapsed.count() << std::setw(14) << std::setprecision(0) << rate << std::setw(9)
+                  << std::setprecision(2) << rate / single << "x" << std::setw(11) << std::setprecision(0)
+                  << 100 * rate / (single * processes) << "%" << std::setw(10) << std::setprecision(4)
+                  << gradePolicy(table, 6).policyEV << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Scaling of the multi-threaded trainer: for 1..N threads, trains a fresh
+// learner on the same total number of hands with each sync mode and reports
+// hands/sec, speed-up over one thread and the exact EV of the policy learned.
+// Near-linear scaling needs N idle hardware threads; past that the workers
+// only take turns on the same cores.
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "PolicyGrader.h"
+#include "QLearner.h"
+#include "Trainer.h"
+
+int main(int argc, char* argv[]) {
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int maxThreads = (argc > 1) ? std::stoi(argv[1]) : cores;
+    long long hands = (argc > 2) ? static_cast<long long>(std::stod(argv[2])) : 4000000;
+    setMasterSeed(42);
+
+    std::cout << "Multi-threaded training, " << hands << " hands per run, " << std::thread::hardware_concurrency()
+              << " hardware threads" << std::endl;
+    std::cout << std::setw(8) << "Sync" << std::setw(9) << "Threads" << std::setw(10) << "Seconds" << std::setw(14)
+              << "Hands/sec" << std::setw(10) << "Speed-up" << std::setw(12) << "Efficiency" << std::setw(10) << "EV"
+              << std::endl;
+    std::cout << std::fixed;
+
+    for (TrainerSync sync : {TrainerSync::Shadow, TrainerSync::Shared}) {
+        double single = 0;
+        for (int threads = 1; threads <= maxThreads; ++threads) {
+            QLearner ai;
+            TrainerConfig config;
+            config.threads = threads;
+            config.sync = sync;
+            config.log = nullptr;
+            // One thread too goes through the parallel trainer, so every row runs the same code
+            TrainerStats stats = runParallelTrainer(ai, hands, config);
+
+            if (threads == 1) single = stats.handsPerSecond;
+            std::cout << std::setw(8) << (sync == TrainerSync::Shadow ? "shadow" : "shared") << std::setw(9) << threads
+                      << std::setw(10) << std::setprecision(2) << stats.seconds << std::setw(14) << std::setprecision(0)
+                      << stats.handsPerSecond << std::setw(9) << std::setprecision(2) << stats.handsPerSecond / single
+                      << "x" << std::setw(11) << std::setprecision(0) << 100 * stats.handsPerSecond / (single * threads)
+                      << "%" << std::setw(10) << std::setprecision(4) << gradePolicy(ai.qTable, 6).policyEV
+                      << std::endl;
+        }
+    }
+    return 0;
+}
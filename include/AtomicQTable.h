@@ -0,0 +1,76 @@
+#ifndef ATOMIC_QTABLE_H
+#define ATOMIC_QTABLE_H
+
+#include <atomic>
+#include <memory>
+#include "QTable.h"
+
+// The values and touched flags of an AtomicQTable in one fixed-size block, so the
+// same layout can sit on the heap or in a segment mapped by several processes.
+// Lock-free atomics hold nothing but the value, which is what lets other
+// processes share them; the block is only ever zero-filled, never constructed.
+struct AtomicQTableStorage {
+    std::atomic<double> values[QTable::STATES * QTable::ACTIONS];
+    std::atomic<bool> touched[QTable::STATES];
+};
+
+static_assert(std::atomic<double>::is_always_lock_free && std::atomic<bool>::is_always_lock_free,
+              "AtomicQTableStorage is shared between processes, which needs address-free atomics");
+
+// Atomic mirror of QTable (same indexing), so threads can update it in place
+// without locks. Owns its storage unless given one, e.g. a shared-memory segment.
+class AtomicQTable {
+public:
+    AtomicQTable() : owned(new AtomicQTableStorage()), data(owned.get()) {
+        for (auto& v : data->values) v.store(0.0, std::memory_order_relaxed);
+        for (auto& t : data->touched) t.store(false, std::memory_order_relaxed);
+    }
+    explicit AtomicQTable(AtomicQTableStorage& storage) : data(&storage) {}
+
+    double get(const State& s, int action) const {
+        return data->values[QTable::index(s) * QTable::ACTIONS + action].load(std::memory_order_relaxed);
+    }
+
+    // Lock-free Bellman update: retry until no other thread changed the value under us
+    double update(const State& s, int action, double reward, double gamma, double alpha, double maxNextQ) {
+        std::atomic<double>& q = data->values[QTable::index(s) * QTable::ACTIONS + action];
+        double oldQ = q.load(std::memory_order_relaxed);
+        double step = alpha * (reward + gamma * maxNextQ - oldQ);
+        while (!q.compare_exchange_weak(oldQ, oldQ + step, std::memory_order_relaxed)) {
+            step = alpha * (reward + gamma * maxNextQ - oldQ);
+        }
+        data->touched[QTable::index(s)].store(true, std::memory_order_relaxed);
+        return step;
+    }
+
+    int size() const {
+        int n = 0;
+        for (const auto& t : data->touched) n += t.load(std::memory_order_relaxed) ? 1 : 0;
+        return n;
+    }
+
+    void loadFrom(const QTable& table) {
+        for (int i = 0; i < QTable::STATES; ++i) {
+            const double* q = table.at(i);
+            data->values[i * 2].store(q[0], std::memory_order_relaxed);
+            data->values[i * 2 + 1].store(q[1], std::memory_order_relaxed);
+            data->touched[i].store(table.isKnown(i), std::memory_order_relaxed);
+        }
+    }
+
+    void storeTo(QTable& table) const {
+        for (int i = 0; i < QTable::STATES; ++i) {
+            if (!data->touched[i].load(std::memory_order_relaxed)) continue;
+            double* q = table.at(i);
+            q[0] = data->values[i * 2].load(std::memory_order_relaxed);
+            q[1] = data->values[i * 2 + 1].load(std::memory_order_relaxed);
+            table.markKnown(i);
+        }
+    }
+
+private:
+    std::unique_ptr<AtomicQTableStorage> owned;
+    AtomicQTableStorage* data;
+};
+
+#endif
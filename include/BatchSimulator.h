@@ -0,0 +1,75 @@
+#ifndef BATCH_SIMULATOR_H
+#define BATCH_SIMULATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "QTable.h"
+#include "Random.h"
+#include "RuleSet.h"
+
+struct BatchResult {
+    long long hands = 0;
+    long long wins = 0;
+    long long pushes = 0;
+    long long losses = 0;
+    long long blackjacks = 0;  // Naturals paid at blackjackPays, also counted in wins
+    double blackjackPays = 1;
+
+    double totalReward() const { return static_cast<double>(wins - blackjacks - losses) + blackjacks * blackjackPays; }
+    double ev() const { return hands > 0 ? totalReward() / hands : 0; }
+};
+
+// Plays the same rules as playRound, a RuleSet picked at construction (classic:
+// dealer stands on soft 17, a two-card 21 wins 1:1 at once, no peek), with a
+// frozen greedy policy, many hands at a time. Both kernels are templates over
+// HouseRules, so the rule checks cost nothing inside the lockstep loops.
+//
+// Hands are integer state machines: a byte holding the hard total (bits 0-4)
+// and whether the hand holds an ace (bit 5). A precomputed table maps
+// (state, card value) to the next state, so hitting is one lookup (the AVX2
+// kernel evaluates the same mapping in registers, checked at compile time).
+// Lanes live in struct-of-arrays blocks of 16 that an AVX2 kernel steps in
+// lockstep; CPUs without AVX2 run a scalar kernel with the exact same
+// lockstep schedule, so both produce identical results for the same seed.
+//
+// Cards come from an infinite deck (each rank 1/13), so results match a
+// freshly shuffled shoe rather than a deep-dealt one.
+class BatchSimulator {
+public:
+    // Hands stepped in lockstep: two AVX2 vectors, interleaved to hide gather latency
+    static constexpr int LANES = 16;
+
+    // lanes is rounded up to a multiple of LANES
+    explicit BatchSimulator(const QTable& policy, uint64_t streamId = STREAM_BATCH, int lanes = 2048,
+                            const RuleSet& rules = RuleSet());
+
+    // Plays at least `hands` hands (rounded up to a multiple of LANES)
+    BatchResult run(long long hands);
+
+    void setUseAvx2(bool enabled) { useAvx2 = enabled && hasAvx2(); }
+    bool usingAvx2() const { return useAvx2; }
+    static bool hasAvx2();
+
+    // Per-lane generator state, one xoshiro128** per lane
+    struct alignas(32) LaneBlock {
+        uint32_t s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+    };
+
+    // Greedy action for each (dealer up-card, hand state), laid out
+    // upCard * HAND_STATES + state so the scalar kernel skips the total lookup.
+    // The AVX2 kernel uses policyBits instead: bit t of entry u is set when the
+    // policy hits on total t against up-card u, so a lookup is a shift.
+    static constexpr int HAND_STATES = 64;
+    struct Tables {
+        alignas(32) int32_t policy[QTable::DEALER_CARDS * HAND_STATES];
+        alignas(32) uint32_t policyBits[16];
+    };
+
+private:
+    Tables tables;
+    RuleSet rules;
+    std::vector<LaneBlock> blocks;
+    bool useAvx2;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Fixed-capacity FIFO between pipeline threads. push() waits while the queue
+// is full, pop() while it is empty; close() wakes everyone, after which pushes
+// fail and pops drain what is left, then fail.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.size() >= capacity && !closed) ++fullWaits;
+        notFull.wait(lock, [this]() { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        if (items.size() > highWater) highWater = items.size();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.empty() && !closed) ++emptyWaits;
+        notEmpty.wait(lock, [this]() { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // Times a producer found the queue full or a consumer found it empty, and the deepest it has been
+    size_t getFullWaits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return fullWaits;
+    }
+    size_t getEmptyWaits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return emptyWaits;
+    }
+    size_t getHighWater() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return highWater;
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    size_t fullWaits = 0;
+    size_t emptyWaits = 0;
+    size_t highWater = 0;
+    mutable std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif
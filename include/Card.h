@@ -1,22 +1,50 @@
 #ifndef CARD_H
 #define CARD_H
 
+#include <cstdint>
 #include <string>
-#include <vector>
-#include <algorithm>
-#include <random>
-#include <chrono>
 
-enum class Suit { SPADES, HEARTS, DIAMONDS, CLUBS };
-enum class Rank { ACE = 1, TWO, THREE, FOUR, FIVE, SIX, SEVEN, EIGHT, NINE, TEN, JACK, QUEEN, KING };
+enum class Suit : uint8_t { SPADES, HEARTS, DIAMONDS, CLUBS };
+enum class Rank : uint8_t { ACE = 1, TWO, THREE, FOUR, FIVE, SIX, SEVEN, EIGHT, NINE, TEN, JACK, QUEEN, KING };
 
+// A card packed into one byte: rank in the low 4 bits, suit in the next 2.
 class Card {
+private:
+    uint8_t code;
+
+    // Indexed by rank; aces count 11 here and 1 in HARD_VALUES
+    static constexpr uint8_t VALUES[14] = {0, 11, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10};
+    static constexpr uint8_t HARD_VALUES[14] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10};
+    // Hi-Lo count tags: 2-6 are +1, 7-9 are 0, tens and aces are -1
+    static constexpr int8_t HI_LO[14] = {0, -1, 1, 1, 1, 1, 1, 0, 0, 0, -1, -1, -1, -1};
+
 public:
-    Suit suit;
-    Rank rank;
-    Card(Rank r = Rank::ACE, Suit s = Suit::SPADES);
-    int getValue() const;
+    constexpr Card(Rank r = Rank::ACE, Suit s = Suit::SPADES)
+        : code(static_cast<uint8_t>(static_cast<uint8_t>(r) | (static_cast<uint8_t>(s) << 4))) {}
+
+    constexpr Rank getRank() const { return static_cast<Rank>(code & 0x0F); }
+    constexpr Suit getSuit() const { return static_cast<Suit>(code >> 4); }
+    constexpr int getValue() const { return VALUES[code & 0x0F]; }
+    constexpr int getHardValue() const { return HARD_VALUES[code & 0x0F]; }
+    constexpr int getHiLo() const { return HI_LO[code & 0x0F]; }
+    constexpr bool isAce() const { return (code & 0x0F) == static_cast<uint8_t>(Rank::ACE); }
+
+    // Dense 0-51 id (suit-major, matching Deck order), handy for lookup tables
+    constexpr int getId() const { return (code >> 4) * 13 + (code & 0x0F) - 1; }
+    static constexpr Card fromId(int id) {
+        return Card(static_cast<Rank>(id % 13 + 1), static_cast<Suit>(id / 13));
+    }
+
+    // The packed byte itself (6 significant bits), for compact serialization
+    constexpr uint8_t getCode() const { return code; }
+    static constexpr Card fromCode(uint8_t code) {
+        return Card(static_cast<Rank>(code & 0x0F), static_cast<Suit>((code >> 4) & 0x03));
+    }
+    static constexpr bool isValidCode(uint8_t code) { return (code & 0x0F) >= 1 && (code & 0x0F) <= 13 && code < 0x40; }
+
     std::string toString() const;
 };
 
-#endif
\ No newline at end of file
+static_assert(sizeof(Card) == 1, "Card must stay packed into a single byte");
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef COUNT_LEARNER_H
+#define COUNT_LEARNER_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "CountQTable.h"
+#include "Hand.h"
+#include "Random.h"
+#include "Shoe.h"
+#include "Trainer.h"
+
+// Q-learner over CountState, the same algorithm as QLearner. With useCount
+// off every hand lands in the neutral bucket, which gives a count-blind
+// baseline that differs only in what it can see.
+class CountLearner {
+public:
+    CountQTable qTable;
+
+    // Each state-action learns at 1/visits (a running mean) until that falls to alpha.
+    // Count deviations are worth fractions of a percent, far below the noise a
+    // constant rate like QLearner's 0.1 leaves in the values.
+    double alpha = 0.001;
+    double gamma = 1.0;   // Episodes are a few steps long; the reward at the end is what matters
+    double epsilon = 0.1;
+    bool useCount = true;
+    Rng rng = streamRng(STREAM_COUNT_EXPLORE);
+    std::vector<uint32_t> visits = std::vector<uint32_t>(CountQTable::STATES * CountQTable::ACTIONS, 0);
+
+    int decide(const CountState& s, bool training = true);
+    void update(const CountState& s, int action, double reward, const CountState& nextS, bool isDone);
+};
+
+// Plays one hand on `shoe` and returns its result. decide(CountState) picks
+// the action; learn(s, action, reward, next, done) sees every transition.
+// `bucket` receives the true count bucket the hand started in, whether or not
+// the states show it.
+template <typename Decide, typename Learn>
+double playCountHand(Shoe& shoe, bool useCount, Decide decide, Learn learn, int& bucket) {
+    shoe.prepareRound();
+    // Taken before the deal: the dealer's hole card must not leak into the state
+    bucket = CountQTable::bucketOf(shoe.getTrueCount());
+    int stateBucket = useCount ? bucket : CountQTable::NEUTRAL_BUCKET;
+
+    Hand player, dealer;
+    player.addCard(shoe.dealCard());
+    dealer.addCard(shoe.dealCard());
+    player.addCard(shoe.dealCard());
+    dealer.addCard(shoe.dealCard());
+    if (player.getTotal() == 21) return 1.0;
+
+    int upcard = dealer.getCard(0).getValue();
+    CountState current = {player.getTotal(), upcard, player.isSoft(), stateBucket};
+    while (decide(current) == 1) {
+        player.addCard(shoe.dealCard());
+        CountState nextState = {player.getTotal(), upcard, player.isSoft(), stateBucket};
+        if (player.isBust()) {
+            learn(current, 1, -1.0, nextState, true);
+            return -1.0;
+        }
+        learn(current, 1, 0, nextState, false);
+        current = nextState;
+    }
+
+    while (dealer.getTotal() < 17) dealer.addCard(shoe.dealCard());
+    double reward = 0;
+    if (dealer.isBust() || player.getTotal() > dealer.getTotal()) reward = 1.0;
+    else if (player.getTotal() < dealer.getTotal()) reward = -1.0;
+    learn(current, 0, reward, current, true);
+    return reward;
+}
+
+// Trains on one persistent shoe of config.decks decks, reshuffled at
+// config.penetration, so the learner sees the true counts a real shoe produces.
+// A natural ends the hand before any decision, as in playRound.
+void runCountTrainer(CountLearner& ai, long long hands, const TrainerConfig& config);
+
+struct CountEvalResult {
+    long long hands = 0;
+    double ev = 0;
+    double stdError = 0;
+    long long handsByBucket[CountQTable::COUNT_BUCKETS] = {};
+    double returnByBucket[CountQTable::COUNT_BUCKETS] = {};
+    long long decisiveByBucket[CountQTable::COUNT_BUCKETS] = {}; // Wins and losses, for the variance
+    double seconds = 0;
+};
+
+// Plays the greedy policy of `policy` on persistent shoes, one per thread
+// (same seed and thread count, same shoes), and reports EV by true count.
+CountEvalResult evaluateCountPolicy(const CountQTable& policy, bool useCount, long long hands, int decks,
+                                    double penetration, int threads);
+
+// Side-by-side EV of a count-aware and a count-blind policy per true count
+// bucket, then the count-aware policy's deviations from its own neutral-count
+// play in the hard 12-16 decisions where basic strategy is closest.
+void printCountComparison(std::ostream& out, const CountEvalResult& aware, const CountEvalResult& blind,
+                          const CountQTable& policy);
+
+#endif
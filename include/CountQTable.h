@@ -0,0 +1,67 @@
+#ifndef COUNT_QTABLE_H
+#define COUNT_QTABLE_H
+
+#include <array>
+#include <cmath>
+#include "QTable.h"
+
+// State for the count-aware learner: the basic State with a real soft-hand
+// flag, plus the shoe's Hi-Lo true count at the start of the round, rounded
+// and clamped to one of COUNT_BUCKETS buckets.
+struct CountState {
+    int pTotal;
+    int dCard;
+    bool soft;
+    int countBucket; // 0 .. CountQTable::COUNT_BUCKETS - 1; NEUTRAL_BUCKET is a true count of 0
+};
+
+// Dense Q-table over CountState. Each count bucket is one slab laid out exactly
+// like a QTable (12KB of values), with the buckets one after another. The count
+// moves slowly within a shoe, so training and play stay inside one or two
+// slabs at a time even though the whole table is 11x the size of a QTable.
+class CountQTable {
+public:
+    static constexpr int MIN_COUNT = -5;
+    static constexpr int MAX_COUNT = 5;
+    static constexpr int COUNT_BUCKETS = MAX_COUNT - MIN_COUNT + 1;
+    static constexpr int NEUTRAL_BUCKET = -MIN_COUNT;
+    static constexpr int STATES_PER_BUCKET = QTable::STATES;
+    static constexpr int STATES = COUNT_BUCKETS * STATES_PER_BUCKET;
+    static constexpr int ACTIONS = QTable::ACTIONS;
+
+    static int bucketOf(double trueCount) {
+        long rounded = std::lround(trueCount);
+        if (rounded < MIN_COUNT) rounded = MIN_COUNT;
+        if (rounded > MAX_COUNT) rounded = MAX_COUNT;
+        return static_cast<int>(rounded) - MIN_COUNT;
+    }
+    static constexpr int countOf(int bucket) { return bucket + MIN_COUNT; }
+
+    static constexpr int index(const CountState& s) {
+        return s.countBucket * STATES_PER_BUCKET + QTable::index(State{s.pTotal, s.dCard, s.soft});
+    }
+
+    const double* at(const CountState& s) const { return &values[index(s) * ACTIONS]; }
+    const double* at(int i) const { return &values[i * ACTIONS]; }
+    double* at(int i) { return &values[i * ACTIONS]; }
+
+    bool isKnown(int i) const { return known[i]; }
+    void markKnown(int i) { known[i] = true; }
+
+    int size() const {
+        int n = 0;
+        for (bool k : known) n += k ? 1 : 0;
+        return n;
+    }
+
+    int greedyAction(const CountState& s) const {
+        const double* q = at(s);
+        return (q[1] > q[0]) ? 1 : 0;
+    }
+
+private:
+    alignas(64) std::array<double, STATES * ACTIONS> values{};
+    std::array<bool, STATES> known{};
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef DEALER_ODDS_H
+#define DEALER_ODDS_H
+
+#include <array>
+
+// Where the dealer ends up, as playRound plays it: draw until 17 or more,
+// stand on every 17 (soft too), no peek for blackjack.
+enum DealerOutcome { DEALER_17, DEALER_18, DEALER_19, DEALER_20, DEALER_21, DEALER_BUST, DEALER_OUTCOMES };
+
+using DealerDistribution = std::array<double, DEALER_OUTCOMES>;
+
+// Exact dealer final-total distributions for each up-card (values 2-11).
+// decks == 0 is an infinite deck; otherwise the dealer draws without
+// replacement from `decks` full decks minus the up-card (player cards are not
+// removed). Distributions are computed once per deck count and shared.
+class DealerOdds {
+private:
+    int decks;
+    std::array<DealerDistribution, 12> byUpCard{}; // Indexed by up-card value
+
+    explicit DealerOdds(int decks);
+
+public:
+    static const DealerOdds& get(int decks = 0);
+
+    int getDecks() const { return decks; }
+    const DealerDistribution& forUpCard(int upValue) const { return byUpCard[upValue]; }
+
+    // Expected return of standing on `playerTotal` (<= 21) against `upValue`
+    double standEV(int playerTotal, int upValue) const;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <ostream>
+#include "QTable.h"
+#include "RuleSet.h"
+
+struct EvalResult {
+    int threads = 0;
+    bool avx2 = false;
+    long long hands = 0;
+    long long wins = 0;
+    long long pushes = 0;
+    long long losses = 0;
+    long long blackjacks = 0; // Wins that were naturals, paid at the rules' blackjack payout
+    double ev = 0;        // Mean return per hand (+1 win, +payout natural, 0 push, -1 loss)
+    double stdError = 0;  // Standard error of ev
+    double ciLow = 0;     // 95% confidence interval for the true ev
+    double ciHigh = 0;
+    double seconds = 0;
+    double handsPerSecond = 0;
+};
+
+// Plays `hands` hands of the greedy Q-table policy with no exploration and no
+// output, split across `threads` BatchSimulators (one RNG stream each, so a
+// given seed and thread count always gives the same result). Uses the
+// simulator's infinite deck under `rules`, which match playRound otherwise.
+EvalResult evaluatePolicy(const QTable& qTable, long long hands, int threads = 1, const RuleSet& rules = RuleSet());
+
+void printEvalResult(std::ostream& out, const EvalResult& result);
+void writeEvalJson(std::ostream& out, const EvalResult& result);
+
+#endif
@@ -1,18 +1,40 @@
 #ifndef HAND_H
 #define HAND_H
 
-#include <vector>
+#include <cstdint>
 #include "Card.h"
 
+// Cards are stored inline and the total is kept up to date as cards arrive,
+// so a Hand never allocates and every total/bust/soft check is O(1).
 class Hand {
+public:
+    // A hand keeps drawing only while its hard total is at most 21, so even
+    // twenty-one aces plus the card that busts it fits.
+    static constexpr int MAX_CARDS = 22;
+
 private:
-    std::vector<Card> cards;
+    Card cards[MAX_CARDS];
+    uint8_t count = 0;
+    uint8_t hardTotal = 0; // Every ace counted as 1
+    uint8_t aces = 0;
+
 public:
     Hand();
     Card getCard(int index) const;
-    void addCard(const Card& card);
-    int getTotal() const;
-    bool isBust() const;
-    int getSize() const;
+    // All MAX_CARDS slots; only the first getSize() hold dealt cards
+    const Card* cardData() const { return cards; }
+
+    void addCard(const Card& card) {
+        if (count == MAX_CARDS) return; // Unreachable: the hand is bust long before
+        cards[count++] = card;
+        hardTotal += card.getHardValue();
+        aces += card.isAce() ? 1 : 0;
+    }
+
+    // One ace may count as 11 when that does not bust the hand
+    int getTotal() const { return hardTotal + (isSoft() ? 10 : 0); }
+    bool isSoft() const { return aces > 0 && hardTotal + 10 <= 21; }
+    bool isBust() const { return hardTotal > 21; }
+    int getSize() const { return count; }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,187 @@
+#ifndef HAND_HISTORY_H
+#define HAND_HISTORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Hand.h"
+
+// Append-only binary log of every hand played. After a 16-byte file header
+// the log is a sequence of variable-length records:
+//
+//   session  byte 0 = 0, byte 1 = source, byte 2 = decks,
+//            byte 3 = rules: blackjack payout (2 bits, BlackjackPayout) | dealer peeks (1 bit) | H17 (1 bit),
+//            then the 64-bit master seed the session ran with (12 bytes)
+//   hand     byte 0 = player cards (5 bits) | outcome (2 bits) | reshuffled (1 bit)
+//            byte 1 = dealer cards (5 bits)
+//            then every card's code (Card::getCode(), 6 bits), player's then
+//            dealer's, packed low bit first and padded to a whole byte
+//
+// A typical hand takes 5 or 6 bytes. Actions are not stored because the
+// cards imply them: the player hit once for every card after the first two,
+// then stood unless the hand went bust or was settled at the deal. Logs
+// written before the rules were recorded have 0 there, which is the classic game.
+enum class HistorySource : uint8_t { Training = 0, Play = 1 };
+enum class HandOutcome : uint8_t { Loss = 0, Push = 1, Win = 2, Blackjack = 3 };
+
+struct HandHistoryHeader {
+    char magic[8]; // "BJHANDS\0"
+    uint32_t version;
+    uint32_t headerSize;
+};
+
+static_assert(sizeof(HandHistoryHeader) == 16, "HandHistoryHeader must stay 16 bytes");
+
+struct RuleSet;
+
+// Reward for an outcome, with a natural paying `blackjackPays` to 1
+inline double outcomeReward(HandOutcome outcome, double blackjackPays = 1.0) {
+    static constexpr double REWARDS[4] = {-1.0, 0.0, 1.0, 0.0};
+    return outcome == HandOutcome::Blackjack ? blackjackPays : REWARDS[static_cast<int>(outcome)];
+}
+
+// Result of a finished hand under the dealer-stands-on-17 rules (naturals are flagged by the caller)
+inline HandOutcome settleHand(const Hand& player, const Hand& dealer) {
+    if (player.isBust()) return HandOutcome::Loss;
+    if (dealer.isBust() || player.getTotal() > dealer.getTotal()) return HandOutcome::Win;
+    if (player.getTotal() < dealer.getTotal()) return HandOutcome::Loss;
+    return HandOutcome::Push;
+}
+
+// Encoded records waiting to be written. Worker threads fill their own block
+// and hand it to the writer in one piece, so encoding never takes a lock.
+class HandHistoryBlock {
+public:
+    void beginSession(HistorySource source, uint64_t seed, int decks, const RuleSet& rules);
+    void record(const Hand& player, const Hand& dealer, HandOutcome outcome, bool reshuffled);
+
+    size_t size() const { return used; }
+    long long hands() const { return handCount; }
+    void clear() { // Keeps the memory for the next batch
+        used = 0;
+        handCount = 0;
+    }
+
+private:
+    friend class HandHistoryWriter;
+    // Room for `count` more bytes at the end; the vector only grows, so records are written in place
+    uint8_t* tail(size_t count) {
+        if (used + count > bytes.size()) bytes.resize(std::max(bytes.size() * 2, used + count + 4096));
+        return bytes.data() + used;
+    }
+
+    std::vector<uint8_t> bytes;
+    size_t used = 0;
+    long long handCount = 0;
+};
+
+// Appends to a log file, creating it (with its header) if it does not exist.
+// A torn record at the end of an existing log (a run killed mid-flush) is cut off first.
+// Records are buffered and written in large chunks; the destructor flushes.
+// record() and append() may be called from several threads.
+class HandHistoryWriter {
+public:
+    static constexpr size_t BLOCK_BYTES = 64 * 1024; // Suggested size for a worker's block before append()
+
+    explicit HandHistoryWriter(const std::string& path, size_t bufferBytes = 1 << 20);
+    ~HandHistoryWriter();
+
+    HandHistoryWriter(const HandHistoryWriter&) = delete;
+    HandHistoryWriter& operator=(const HandHistoryWriter&) = delete;
+
+    bool isOpen() const { return open; }
+    void beginSession(HistorySource source, uint64_t seed, int decks, const RuleSet& rules);
+    void record(const Hand& player, const Hand& dealer, HandOutcome outcome, bool reshuffled);
+    void append(const HandHistoryBlock& block); // Copies the block; the caller clears and reuses it
+    bool flush();
+    long long handsWritten() const;
+
+private:
+    bool flushLocked();
+
+    std::string path;
+    std::ofstream out;
+    bool open = false;
+    size_t bufferBytes;
+    HandHistoryBlock buffer;
+    long long hands = 0;
+    mutable std::mutex mutex;
+};
+
+// One decoded hand, with the session it belongs to
+struct HandRecord {
+    Hand player;
+    Hand dealer;
+    HandOutcome outcome = HandOutcome::Loss;
+    bool reshuffled = false;
+    HistorySource source = HistorySource::Training;
+    uint64_t seed = 0;
+    int decks = 0;
+    // The session's house rules
+    double blackjackPays = 1.0;
+    bool dealerPeeks = false;
+    bool hitsSoft17 = false;
+
+    double reward() const { return outcomeReward(outcome, blackjackPays); }
+    // A natural, or with peek the dealer's: the hand ended before the player decided anything
+    bool settledAtDeal() const {
+        return outcome == HandOutcome::Blackjack || (dealerPeeks && dealer.getSize() == 2 && dealer.getTotal() == 21);
+    }
+};
+
+// Read-only mapping of a log, decoded one record at a time. Memory use does
+// not grow with the file: pages are read ahead and dropped by the kernel.
+class HandHistoryReader {
+public:
+    explicit HandHistoryReader(const std::string& path);
+    ~HandHistoryReader();
+
+    HandHistoryReader(const HandHistoryReader&) = delete;
+    HandHistoryReader& operator=(const HandHistoryReader&) = delete;
+
+    bool isOpen() const { return mapping != nullptr; }
+    bool next(HandRecord& hand); // False at the end of the log
+    // True if reading stopped at a torn or corrupt record (e.g. the writer was killed mid-flush)
+    bool isTruncated() const { return truncated; }
+    long long sessionCount() const { return sessions; }
+    size_t bytesRead() const { return offset; }
+    size_t fileSize() const { return length; }
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+    size_t offset = 0;
+    bool truncated = false;
+    long long sessions = 0;
+    HistorySource source = HistorySource::Training;
+    uint64_t seed = 0;
+    int decks = 0;
+    uint8_t rules = 0;
+};
+
+struct HandHistoryStats {
+    long long sessions = 0;
+    long long hands = 0;
+    long long trainingHands = 0;
+    long long wins = 0, pushes = 0, losses = 0, blackjacks = 0;
+    long long dealerPeeks = 0; // Hands the dealer's natural ended at the deal
+    long long playerBusts = 0, dealerBusts = 0;
+    long long hits = 0;
+    long long reshuffles = 0;
+    double totalReward = 0;
+    // Indexed by the dealer's up-card value (2-11)
+    long long handsByUpcard[12] = {};
+    double rewardByUpcard[12] = {};
+    bool truncated = false;
+    double seconds = 0;
+};
+
+HandHistoryStats scanHandHistory(HandHistoryReader& reader);
+void printHandHistoryStats(std::ostream& out, const HandHistoryStats& stats);
+
+#endif
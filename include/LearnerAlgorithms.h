@@ -0,0 +1,179 @@
+#ifndef LEARNER_ALGORITHMS_H
+#define LEARNER_ALGORITHMS_H
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include "Hand.h"
+#include "QLearner.h"
+
+struct TrainerConfig;
+
+enum class LearnerAlgorithm {
+    QLearning,     // Off-policy, bootstraps from max Q(s') (QLearner::update, the default)
+    Sarsa,         // On-policy, bootstraps from Q(s', a') for the action it then plays
+    ExpectedSarsa, // Bootstraps from the epsilon-greedy expectation over Q(s')
+    DoubleQ,       // Two tables, each evaluated by the other, to remove max's upward bias
+    MonteCarlo     // Every-visit constant-alpha Monte Carlo control on whole-hand returns
+};
+
+const char* algorithmName(LearnerAlgorithm algorithm);
+// Accepts the names algorithmName gives ("q", "sarsa", "expected-sarsa", "double-q", "monte-carlo")
+bool parseAlgorithm(const std::string& name, LearnerAlgorithm& out);
+
+// The algorithms are agents over a QLearner: it keeps the table, gamma, the rates and
+// their schedules and the exploration RNG, and the agent decides how experience turns
+// into updates. The trainer's hand loop is a template instantiated once per algorithm,
+// so there is no virtual call per step. An agent provides
+//   int decide(State s, bool training)
+//   double update(State s, int action, double reward, State next, bool done) - the change made
+//   void finish() - leaves the learned policy in ai.qTable
+
+struct QLearningAgent {
+    QLearner& ai;
+
+    int decide(State s, bool training) { return ai.decide(s, training); }
+    double update(State s, int action, double reward, State next, bool done) {
+        return ai.update(s, action, reward, next, done);
+    }
+    void finish() {}
+};
+
+struct SarsaAgent {
+    QLearner& ai;
+    int nextAction = -1; // Picked while updating towards the next state; decide then plays it
+
+    int decide(State s, bool training) {
+        if (nextAction < 0) return ai.decide(s, training);
+        int action = nextAction;
+        nextAction = -1;
+        return action;
+    }
+
+    double update(State s, int action, double reward, State next, bool done) {
+        double nextQ = 0;
+        if (!done) {
+            nextAction = ai.decide(next, true);
+            nextQ = ai.qTable.at(next)[nextAction];
+        }
+        double rate = ai.learningRate(s, action);
+        double* q = ai.qTable[s];
+        double step = rate * (reward + ai.gamma * nextQ - q[action]);
+        q[action] += step;
+        return step;
+    }
+
+    void finish() {}
+};
+
+struct ExpectedSarsaAgent {
+    QLearner& ai;
+
+    int decide(State s, bool training) { return ai.decide(s, training); }
+
+    double update(State s, int action, double reward, State next, bool done) {
+        double expectedQ = 0;
+        if (!done) {
+            // Epsilon-greedy over two actions: the greedy one, plus half of epsilon on each
+            const double* n = ai.qTable.at(next);
+            double explore = ai.explorationRate(next);
+            expectedQ = (1 - explore) * std::max(n[0], n[1]) + explore * 0.5 * (n[0] + n[1]);
+        }
+        double rate = ai.learningRate(s, action);
+        double* q = ai.qTable[s];
+        double step = rate * (reward + ai.gamma * expectedQ - q[action]);
+        q[action] += step;
+        return step;
+    }
+
+    void finish() {}
+};
+
+// ai.qTable is table A; B lives in the agent. Mid-run checkpoints therefore hold A alone.
+struct DoubleQAgent {
+    QLearner& ai;
+    QTable other;
+
+    explicit DoubleQAgent(QLearner& learner) : ai(learner), other(learner.qTable) {}
+
+    int decide(State s, bool training) {
+        if (training && ai.rng.uniform() < ai.explorationRate(s)) {
+            return static_cast<int>(ai.rng.below(2));
+        }
+        // Greedy on the sum, which is twice the average the policy ends up with
+        const double* a = ai.qTable.at(s);
+        const double* b = other.at(s);
+        return (a[1] + b[1] > a[0] + b[0]) ? 1 : 0;
+    }
+
+    double update(State s, int action, double reward, State next, bool done) {
+        // A coin decides which table learns; it picks its best next action and the other values it
+        bool learnA = ai.rng.below(2) == 0;
+        QTable& learning = learnA ? ai.qTable : other;
+        const QTable& judging = learnA ? other : ai.qTable;
+        double nextQ = 0;
+        if (!done) {
+            const double* n = learning.at(next);
+            nextQ = judging.at(next)[(n[1] > n[0]) ? 1 : 0];
+        }
+        double rate = ai.learningRate(s, action);
+        double* q = learning[s];
+        double step = rate * (reward + ai.gamma * nextQ - q[action]);
+        q[action] += step;
+        return step;
+    }
+
+    void finish() {
+        for (int i = 0; i < QTable::STATES; ++i) {
+            if (!ai.qTable.isKnown(i) && !other.isKnown(i)) continue;
+            double* a = ai.qTable.at(i);
+            const double* b = other.at(i);
+            a[0] = 0.5 * (a[0] + b[0]);
+            a[1] = 0.5 * (a[1] + b[1]);
+            ai.qTable.markKnown(i);
+        }
+    }
+};
+
+// Holds the hand's steps until it ends, then moves each towards its discounted return
+struct MonteCarloAgent {
+    QLearner& ai;
+    State states[Hand::MAX_CARDS]{};
+    int actions[Hand::MAX_CARDS]{};
+    double rewards[Hand::MAX_CARDS]{};
+    int steps = 0;
+
+    int decide(State s, bool training) { return ai.decide(s, training); }
+
+    // Returns the total |change| over the hand, all of it on the final step
+    double update(State s, int action, double reward, State, bool done) {
+        states[steps] = s;
+        actions[steps] = action;
+        rewards[steps] = reward;
+        ++steps;
+        if (!done) return 0;
+
+        double total = 0;
+        double ret = 0;
+        for (int t = steps - 1; t >= 0; --t) {
+            ret = rewards[t] + ai.gamma * ret;
+            double rate = ai.learningRate(states[t], actions[t]);
+            double* q = ai.qTable[states[t]];
+            double step = rate * (ret - q[actions[t]]);
+            q[actions[t]] += step;
+            total += std::abs(step);
+        }
+        steps = 0;
+        return total;
+    }
+
+    void finish() {}
+};
+
+// Trains a fresh copy of `prototype` with each algorithm for `hands` hands on the same
+// seed and shoe, grades every resulting policy exactly, and prints hands/sec, EV and
+// mistakes side by side.
+void compareLearnerAlgorithms(std::ostream& out, const QLearner& prototype, long long hands, const TrainerConfig& config);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef POLICY_GRADER_H
+#define POLICY_GRADER_H
+
+#include <ostream>
+#include <vector>
+#include "QTable.h"
+
+// Exact value of one player hand against one dealer up-card
+struct StateGrade {
+    int playerTotal;
+    bool soft;       // Holds an ace counted as 11
+    int dealerCard;
+    double standEV;
+    double hitEV;    // Hit once, then keep following the graded policy
+    int policyAction; // 0: Stand, 1: Hit, as the greedy Q-table chooses
+    int bestAction;  // Action with the higher EV given the policy afterwards
+};
+
+struct PolicyGrade {
+    int decks = 0;          // 0 = infinite deck
+    double policyEV = 0;    // Expected return per hand of the greedy policy
+    double optimalEV = 0;   // Best hit/stand play under the same rules
+    int mistakes = 0;       // States where policyAction != bestAction
+    std::vector<StateGrade> states;
+};
+
+// Computes the greedy Q-table policy's expected value exactly, from the dealer
+// distributions in DealerOdds. Player draws always come from an infinite
+// deck; `decks` only changes the dealer's distribution.
+PolicyGrade gradePolicy(const QTable& qTable, int decks = 0);
+
+void printPolicyGrade(std::ostream& out, const PolicyGrade& grade, bool showStates = true);
+
+#endif
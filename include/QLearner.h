@@ -1,35 +1,104 @@
 #ifndef QLEARNER_H
 #define QLEARNER_H
 
-#include <map>
+#include <algorithm>
+#include <cstdint>
 #include <string>
-#include <tuple>
+#include <vector>
 #include "Hand.h"
-#include <sqlite3.h>
+#include "QTable.h"
+#include "Random.h"
+#include "Schedule.h"
 
-
-struct State {
-    int pTotal;
-    int dCard;
-    bool hasAce;
-
-    bool operator<(const State& other) const {
-        return std::tie(pTotal, dCard, hasAce) < std::tie(other.pTotal, other.dCard, other.hasAce);
-    }
+// One step of experience, with states as QTable indices so a transition is 12 bytes
+struct Transition {
+    uint16_t state;
+    uint16_t next;
+    uint8_t action;
+    bool done;
+    float reward;
 };
 
+inline Transition makeTransition(const State& s, int action, double reward, const State& nextS, bool isDone) {
+    return Transition{static_cast<uint16_t>(QTable::index(s)), static_cast<uint16_t>(QTable::index(nextS)),
+                      static_cast<uint8_t>(action), isDone, static_cast<float>(reward)};
+}
+
 class QLearner {
 public:
-    std::map<State, double[2]> qTable; // 0: Stand, 1: Hit
+    QTable qTable; // 0: Stand, 1: Hit
     
     double alpha = 0.1;    // Learning rate
     double gamma = 0.9;    // Discount factor
     double epsilon = 0.2;  // Exploration rate (20% of time try random)
+    Rng rng = streamRng(STREAM_PLAY_POLICY); // Drives exploration; the trainer reseeds it per run
 
+    // Constant leaves epsilon/alpha as set above. Hand-based schedules are applied by
+    // advanceSchedules; visit-based ones are looked up per state in decide/update.
+    Schedule epsilonSchedule;
+    Schedule alphaSchedule;
+    // Per state-action, laid out like QTable; only kept while a visit-based schedule is in use
+    std::vector<uint32_t> visits;
+
+    // Sets epsilon/alpha for `hands` hands into training and allocates the visit counts
+    // a visit-based schedule needs. The trainers call it every few hundred hands.
+    void advanceSchedules(long long hands);
+
+    // Inline, like QTable's hot paths, so the trainer's hand loop compiles down to table accesses
     int decide(State s, bool training = true);
-    void update(State s, int action, double reward, State nextS, bool isDone);
-    void saveToDatabase(const std::string& filename);
-    void loadFromDatabase(const std::string& filename);
+    // Returns how far the value moved, for the trainer's telemetry
+    double update(State s, int action, double reward, State nextS, bool isDone);
+    // Epsilon in state s, after any visit-based schedule
+    double explorationRate(State s) const;
+    // Alpha for one update of (s, action). Counts the visit, so call it once per update.
+    double learningRate(State s, int action);
+    // Bellman updates for a batch at learning rate `rate` (replayed experience wants a smaller
+    // one than alpha). Targets are computed from the table as it was before the batch, then
+    // applied. `weights` (optional) scales each step; `tdErrors` (optional) receives each TD error.
+    void updateBatch(const Transition* batch, int count, double rate, const float* weights = nullptr,
+                     float* tdErrors = nullptr);
+    // One-shot save/load through a QTableStore; both report errors and return false on failure
+    bool saveToDatabase(const std::string& filename);
+    bool loadFromDatabase(const std::string& filename);
 };
 
+inline double QLearner::explorationRate(State s) const {
+    if (!epsilonSchedule.perState() || visits.empty()) return epsilon;
+    const uint32_t* n = &visits[QTable::index(s) * QTable::ACTIONS];
+    return epsilonSchedule.at(static_cast<double>(n[0]) + n[1]);
+}
+
+inline double QLearner::learningRate(State s, int action) {
+    if (visits.empty()) return alpha;
+    uint32_t n = ++visits[QTable::index(s) * QTable::ACTIONS + action];
+    return alphaSchedule.perState() ? alphaSchedule.at(n) : alpha;
+}
+
+inline int QLearner::decide(State s, bool training) {
+    // Epsilon-greedy: Exploration
+    if (training && rng.uniform() < explorationRate(s)) {
+        return static_cast<int>(rng.below(2));
+    }
+
+    // Exploitation: Choose the best-known move
+    const double* q = qTable.at(s);
+    return (q[1] > q[0]) ? 1 : 0;
+}
+
+inline double QLearner::update(State s, int action, double reward, State nextS, bool isDone) {
+    double maxNextQ = 0;
+    if (!isDone) {
+        const double* next = qTable.at(nextS);
+        maxNextQ = std::max(next[0], next[1]);
+    }
+
+    // The Bellman Equation:
+    // NewQ = OldQ + LearningRate * (Reward + Discount * MaxFutureQ - OldQ)
+    double rate = learningRate(s, action);
+    double* q = qTable[s];
+    double step = rate * (reward + gamma * maxNextQ - q[action]);
+    q[action] += step;
+    return step;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef QTABLE_H
+#define QTABLE_H
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+struct State {
+    int pTotal;
+    int dCard;
+    bool hasAce;
+
+    bool operator<(const State& other) const {
+        return std::tie(pTotal, dCard, hasAce) < std::tie(other.pTotal, other.dCard, other.hasAce);
+    }
+};
+
+// Flat Q-table covering every reachable State. Values for one state sit next
+// to each other ([stand, hit]) and the whole table is ~12KB, so it stays in L1.
+// Hot paths are inline; there is no lookup cost beyond one multiply-add.
+class QTable {
+public:
+    static constexpr int TOTALS = 32;       // Player totals 0-31 (hitting a hard 21 with a ten gives 31)
+    static constexpr int DEALER_CARDS = 12; // Dealer up-card values 0-11
+    static constexpr int STATES = TOTALS * DEALER_CARDS * 2;
+    static constexpr int ACTIONS = 2;       // 0: Stand, 1: Hit
+
+    static constexpr int index(const State& s) {
+        return (s.pTotal * DEALER_CARDS + s.dCard) * 2 + (s.hasAce ? 1 : 0);
+    }
+
+    static constexpr State stateAt(int i) {
+        return State{i / 2 / DEALER_CARDS, (i / 2) % DEALER_CARDS, (i % 2) == 1};
+    }
+
+    // Write access marks the state as known, like inserting into the old map did,
+    // and as dirty so the next incremental save writes it
+    double* operator[](const State& s) {
+        int i = index(s);
+        known[i] = true;
+        dirty[i] = true;
+        return &values[i * ACTIONS];
+    }
+
+    const double* at(const State& s) const { return &values[index(s) * ACTIONS]; }
+    const double* at(int i) const { return &values[i * ACTIONS]; }
+    double* at(int i) { return &values[i * ACTIONS]; }
+
+    bool isKnown(int i) const { return known[i]; }
+    // For writes through at(int): flags the state known and dirty
+    void markKnown(int i) {
+        known[i] = true;
+        dirty[i] = true;
+    }
+
+    // States written since the last clearDirty(), i.e. not yet saved
+    bool isDirty(int i) const { return dirty[i]; }
+    void markDirty(int i) { dirty[i] = true; }
+    void clearDirty() { dirty.fill(false); }
+
+    int size() const {
+        int n = 0;
+        for (bool k : known) n += k ? 1 : 0;
+        return n;
+    }
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        values.fill(0.0);
+        known.fill(false);
+        dirty.fill(false);
+    }
+
+    // Calls fn(State, const double* q) for every known state, in index order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (int i = 0; i < STATES; ++i) {
+            if (known[i]) fn(stateAt(i), at(i));
+        }
+    }
+
+private:
+    alignas(64) std::array<double, STATES * ACTIONS> values{};
+    std::array<bool, STATES> known{};
+    std::array<bool, STATES> dirty{};
+};
+
+static_assert(QTable::index(QTable::stateAt(QTable::STATES - 1)) == QTable::STATES - 1,
+              "QTable::stateAt must invert QTable::index");
+
+#endif
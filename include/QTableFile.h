@@ -0,0 +1,64 @@
+#ifndef QTABLE_FILE_H
+#define QTABLE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "QTable.h"
+
+// Binary Q-table file: a 64-byte header followed by the QTable object's bytes
+// exactly as they sit in memory. A read-only mapping of the file can therefore
+// be used as a `const QTable&` without parsing anything, and every process
+// that maps the same file shares one copy in the page cache.
+//
+// The header records the layout the body was written with, so a build whose
+// QTable differs (more states, more actions) rejects the file instead of
+// misreading it. Convert through the SQLite format when the layout changes.
+struct QTableFileHeader {
+    char magic[8];          // "BJQTABLE"
+    uint32_t version;
+    uint32_t headerSize;    // Offset of the body; keeps it 64-byte aligned
+    uint32_t totals;        // QTable::TOTALS
+    uint32_t dealerCards;   // QTable::DEALER_CARDS
+    uint32_t states;        // QTable::STATES
+    uint32_t actions;       // QTable::ACTIONS
+    uint64_t bodySize;      // sizeof(QTable)
+    uint64_t checksum;      // FNV-1a 64 of the body
+    uint32_t endianCheck;   // 0x01020304 as written by the producing machine
+    uint8_t reserved[12];
+};
+
+static_assert(sizeof(QTableFileHeader) == 64, "QTableFileHeader must stay 64 bytes");
+static_assert(std::is_standard_layout<QTable>::value && std::is_trivially_copyable<QTable>::value,
+              "QTable must be mappable straight from a file");
+
+// Writes the table to `path` atomically (temporary file, then rename); dirty flags are not stored
+bool writeQTableFile(const std::string& path, const QTable& table);
+
+// Read-only mapping of a file written by writeQTableFile. The header and
+// checksum are verified once on open; after that table() is plain memory.
+class MappedQTable {
+public:
+    explicit MappedQTable(const std::string& path);
+    ~MappedQTable();
+
+    MappedQTable(const MappedQTable&) = delete;
+    MappedQTable& operator=(const MappedQTable&) = delete;
+
+    bool isOpen() const { return view != nullptr; }
+    const QTable& table() const { return *view; }
+
+    // Greedy action straight from the mapping, same rule as QLearner::decide(s, false)
+    int decide(const State& s) const {
+        const double* q = view->at(s);
+        return (q[1] > q[0]) ? 1 : 0;
+    }
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+    const QTable* view = nullptr;
+};
+
+#endif
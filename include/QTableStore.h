@@ -0,0 +1,109 @@
+#ifndef QTABLE_STORE_H
+#define QTABLE_STORE_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sqlite3.h>
+#include "QTable.h"
+
+// SQLite persistence for a QTable. Keeps one connection and its prepared
+// statements open, so repeated saves only pay for the rows they write.
+// Rows are keyed on (pTotal, dCard, hasAce) and written with UPSERTs; the
+// database runs in WAL mode so readers never block a save.
+//
+// Every method reports failures on std::cerr and returns false; nothing is
+// dropped silently. Files in the original keyless schema load as they are
+// and are migrated the first time something is written to them.
+class QTableStore {
+public:
+    explicit QTableStore(const std::string& filename);
+    ~QTableStore();
+
+    QTableStore(const QTableStore&) = delete;
+    QTableStore& operator=(const QTableStore&) = delete;
+
+    bool isOpen() const { return db != nullptr; }
+    const std::string& getFilename() const { return filename; }
+
+    // Replaces the table's contents with the stored rows; the loaded rows start clean.
+    // A missing or empty file loads as an empty table and still returns true.
+    bool load(QTable& table);
+
+    // Writes only the dirty states in one transaction, then clears their flags
+    bool saveDirty(QTable& table);
+
+    // Makes the file hold exactly the table's known states
+    bool replace(QTable& table);
+
+    // Deletes every stored row
+    bool clear();
+
+    // Weight vectors of function-approximation learners live in the same file, one
+    // BLOB per name, replaced whole on every save. clear() leaves them alone.
+    bool saveWeights(const std::string& name, const std::vector<float>& weights);
+    // False if nothing is stored under `name` (not an error) or the read failed (reported)
+    bool loadWeights(const std::string& name, std::vector<float>& weights);
+
+    int lastSaveRows() const { return lastRows; }
+
+private:
+    std::string filename;
+    sqlite3* db = nullptr;
+    sqlite3_stmt* upsert = nullptr;
+    sqlite3_stmt* select = nullptr;
+    bool writable = false;
+    int lastRows = 0;
+
+    bool check(int rc, const char* what);
+    bool exec(const char* sql, const char* what);
+    bool prepareForWrites();
+    bool writeRows(const QTable& table, bool onlyDirty);
+};
+
+// Writes snapshots of a training table from a background thread, so long
+// runs can checkpoint without the trainer ever waiting on disk. submit()
+// copies the table (~20KB) and hands it to the writer; if the writer is
+// still busy, the newer snapshot replaces the queued one and their dirty
+// rows are combined, so nothing submitted is lost.
+//
+// With replaceFirst (a new model trained from scratch), the first write
+// replaces the stored rows with the snapshot's in one transaction, so the
+// previous model stays whole in the file until then.
+class QTableCheckpointer {
+public:
+    explicit QTableCheckpointer(QTableStore& store, bool replaceFirst = false);
+    ~QTableCheckpointer(); // Writes whatever is still queued or failed, then stops; reports rows it could not write
+
+    // Snapshots the table's dirty states and clears its dirty flags
+    void submit(QTable& table);
+
+    // Blocks until every submitted snapshot has been written, retrying a failed one once.
+    // Rows that still could not be written are marked dirty again in `table`, so the
+    // caller's next saveDirty() retries them, and flush returns false.
+    bool flush(QTable& table);
+
+    int checkpointsWritten() const;
+    int failures() const;
+
+private:
+    QTableStore& store;
+    std::unique_ptr<QTable> pending; // Latest snapshot not yet picked up by the writer
+    std::unique_ptr<QTable> unsaved; // Snapshot whose write failed; merged into the next one
+    bool replacing;  // Next write replaces the file's rows rather than updating them
+    bool busy = false;
+    bool stopping = false;
+    int written = 0;
+    int failed = 0;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread writer;
+
+    void run();
+};
+
+#endif
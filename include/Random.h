@@ -0,0 +1,81 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+// xoshiro256** - 32 bytes of state and a handful of instructions per draw.
+// Satisfies UniformRandomBitGenerator, so it also works with <random>.
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    explicit Rng(uint64_t seed = 0) { seedWith(seed); }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Unbiased integer in [0, bound) using Lemire's multiply-and-reject method
+    uint32_t below(uint32_t bound) {
+        uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound) {
+            const uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // Uniform double in [0, 1) from the top 53 bits
+    double uniform() { return ((*this)() >> 11) * 0x1.0p-53; }
+
+    void seedWith(uint64_t seed);
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// Stream ids handed to streamRng(). Every consumer of randomness gets its own
+// id, so extra draws in one place never shift the sequence seen by another.
+enum RngStreamId : uint64_t {
+    STREAM_PLAY_SHOE = 1,
+    STREAM_PLAY_POLICY = 2,
+    STREAM_VIDEO_SHOE = 3,   // Hands recorded by VideoExporter
+    STREAM_REPLAY = 4,       // Sampling from a ReplayBuffer
+    STREAM_COUNT_SHOE = 5,   // Shoe of the count-aware trainer
+    STREAM_COUNT_EXPLORE = 6,
+    STREAM_TILE_EXPLORE = 7, // Exploration of the tile-coding learner (it shares the count shoe)
+    STREAM_TRAINER = 16,     // Thread t uses STREAM_TRAINER + 2t (shoe) and + 2t + 1 (exploration)
+    STREAM_BATCH = 1 << 16,  // Batch simulator t uses STREAM_BATCH + t
+    STREAM_COUNT_EVAL = 1 << 17 // Count-aware evaluation thread t uses STREAM_COUNT_EVAL + t
+};
+
+// The master seed every stream is derived from. Drawn from std::random_device
+// on first use unless setMasterSeed() was called first (e.g. by --seed).
+uint64_t getMasterSeed();
+void setMasterSeed(uint64_t seed);
+
+// Independent generator for one stream of the current master seed
+Rng streamRng(uint64_t streamId);
+
+// Generator private to the calling thread, for code without a stream of its own
+Rng& threadRng();
+
+#endif
@@ -1,15 +1,40 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
-#include <map>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <opencv2/opencv.hpp>
 #include "Hand.h"
 
+// Retained-mode table view. The felt and fixed labels are composed once per
+// layout; each frame only repaints the card slots, totals and message that
+// changed since the frame before, into the same cv::Mat.
 class Renderer {
 private:
-    cv::Mat table;
-    std::map<std::string, cv::Mat> cardCache; // Stores resized card images
+    // The two screens place the player's hand differently
+    enum class Layout { None, State, Action };
+
+    // What a hand's row currently shows, so unchanged cards are not redrawn
+    struct DrawnHand {
+        std::array<int, Hand::MAX_CARDS> slots; // Card id, or EMPTY_SLOT / HIDDEN_SLOT
+        std::string total;
+    };
+    static constexpr int EMPTY_SLOT = -1;
+    static constexpr int HIDDEN_SLOT = -2;
+
+    cv::Mat table;            // Retained frame, reused by every draw
+    cv::Mat stateBackground;  // Felt and labels for displayState
+    cv::Mat actionBackground; // Felt, labels and the HIT/STAND buttons for displayActionPrompt
+
+    // Every resized card in one image: faces at Card::getId() (13 per row), then the back
+    static constexpr int ATLAS_COLUMNS = 13;
+    static constexpr int CARD_BACK = 52;
+    static constexpr int SPRITES = 53;
+    cv::Mat atlas;
+    std::array<cv::Mat, SPRITES> sprites; // Views into atlas, no copies
+    std::array<bool, SPRITES> hasSprite{};
     int CARD_WIDTH = 60;
     int CARD_HEIGHT = 90;
     int TABLE_WIDTH = 700;
@@ -17,17 +42,43 @@ private:
     bool windowClosed = false;
     int lastKeyPressed = -1;
 
+    Layout drawnLayout = Layout::None;
+    DrawnHand drawnDealer;
+    DrawnHand drawnPlayer;
+    std::string drawnMessage;
+
+    int frameBudgetMs;        // Minimum time between frames
+    bool offscreen;           // Compose frames only: no window, never waits
+    bool autoAdvance = false; // Prompts time out after one frame instead of waiting for a key
+    std::chrono::steady_clock::time_point lastFrame;
+
     // Helper function to build card filename from Card object
     std::string getCardFilename(const Card& card);
-    
+    std::string spriteFilename(int slot);
+
+    // The atlas is cached on disk after the first launch; the key changes with the PNGs or the card size
+    uint64_t assetKey();
+    bool loadAtlasCache(uint64_t key);
+    void saveAtlasCache(uint64_t key);
+    void decodeAtlas();
+
     // Helper to draw a card at a specific position
     void drawCard(int x, int y, const Card& card, bool hidden = false);
 
+    void composeBackgrounds();
+    void beginFrame(Layout layout);
+    const cv::Mat& background() const;
+    void restore(const cv::Rect& region);
+    void updateHand(DrawnHand& drawn, const Hand& hand, int x, int y, int hiddenIndex);
+    void updateText(std::string& drawn, const std::string& text, const cv::Rect& strip, cv::Point origin,
+                    double scale, const cv::Scalar& color);
+    int showFrame(bool waitForKey);
+
 public:
-    Renderer();
+    explicit Renderer(int frameBudgetMs = 500, bool offscreen = false);
     ~Renderer();
     void loadAssets(); // Load all card PNG files
-    void displayState(const Hand& player, const Hand& dealer, std::string message, bool dealersTurn = false);    
+    void displayState(const Hand& player, const Hand& dealer, std::string message, bool dealersTurn = false);
     void displayPrompt(const Hand& player, const Hand& dealer, const std::string& prompt, const std::string& result = "");
     int displayActionPrompt(const Hand& player, const Hand& dealer, const std::string& message);
     int getKeyPressed() const { return lastKeyPressed; }
@@ -35,6 +86,14 @@ public:
     void resizeWindow(int width, int height);
     bool isWindowClosed() const { return windowClosed; }
     void closeWindow() { windowClosed = true; cv::destroyAllWindows(); }
+
+    // Frames are shown at most once per budget; a small budget lets AI playback run many hands a second
+    void setFrameBudget(int ms) { frameBudgetMs = ms; }
+    // For unattended AI playback: end-of-round prompts continue on their own unless N, Q or Esc is pressed
+    void setAutoAdvance(bool enabled) { autoAdvance = enabled; }
+
+    // The last composed frame; with offscreen rendering this is the only output
+    const cv::Mat& getFrame() const { return table; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,80 @@
+#ifndef REPLAY_BUFFER_H
+#define REPLAY_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "QLearner.h"
+#include "Random.h"
+
+class HandHistoryReader;
+
+enum class ReplaySampling {
+    Uniform,
+    Prioritized // Proportional to |TD error|^priorityExponent (Schaul et al., 2016)
+};
+
+// Transitions drawn for one batched update, gathered into contiguous arrays
+struct ReplayBatch {
+    std::vector<uint32_t> slots;        // Where each transition lives in the buffer
+    std::vector<Transition> transitions;
+    std::vector<float> weights;         // Importance-sampling weights (prioritized only)
+    std::vector<float> tdErrors;        // Filled by QLearner::updateBatch
+};
+
+// Fixed-capacity ring of transitions. Once full, each new transition
+// overwrites the oldest. With prioritized sampling a sum tree over the slots
+// makes both sampling and priority updates O(log capacity).
+class ReplayBuffer {
+public:
+    double priorityExponent = 0.6;   // 0 = uniform, 1 = fully proportional to the TD error
+    double importanceExponent = 0.4; // How strongly the weights undo the sampling bias
+
+    explicit ReplayBuffer(size_t capacity, ReplaySampling sampling = ReplaySampling::Uniform,
+                          Rng rng = streamRng(STREAM_REPLAY));
+
+    void add(const Transition& transition);
+    size_t size() const { return count; }
+    size_t capacity() const { return transitions.size(); }
+    ReplaySampling getSampling() const { return sampling; }
+
+    // Draws `batchSize` transitions (with replacement). Slots are sorted, so the
+    // gather walks the ring front to back instead of jumping around it.
+    void sample(size_t batchSize, ReplayBatch& batch);
+    // New priorities from the TD errors QLearner::updateBatch left in the batch
+    void updatePriorities(const ReplayBatch& batch);
+
+private:
+    void setPriority(size_t slot, double priority);
+    size_t findPrefix(double mass) const;
+
+    std::vector<Transition> transitions;
+    size_t next = 0;
+    size_t count = 0;
+    ReplaySampling sampling;
+    Rng rng;
+
+    // Sum tree: leaves at [leaves, 2 * leaves), each parent the sum of its children
+    size_t leaves = 0;
+    std::vector<double> tree;
+    double maxPriority = 1.0; // New transitions get the highest priority seen, so they are replayed soon
+};
+
+// Samples one batch, applies it to the learner at `rate` and feeds the TD errors back
+void replayBatch(QLearner& ai, ReplayBuffer& buffer, ReplayBatch& batch, size_t batchSize, double rate);
+
+struct HistoryReplayStats {
+    long long hands = 0;
+    long long transitions = 0;
+    long long batches = 0;
+};
+
+// Learns offline from a hand-history log: every recorded hand is turned back
+// into the transitions the trainer would have seen and applied with
+// QLearner::update. Hands settled at the deal (HandRecord::settledAtDeal) had
+// no decision in them and are skipped. With a buffer, each hand also goes into
+// it and `batchesPerHand` batches are replayed at `replayRate`.
+HistoryReplayStats learnFromHistory(QLearner& ai, HandHistoryReader& reader, ReplayBuffer* buffer = nullptr,
+                                    size_t batchSize = 32, int batchesPerHand = 1, double replayRate = 0.005);
+
+#endif
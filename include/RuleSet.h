@@ -0,0 +1,107 @@
+#ifndef RULE_SET_H
+#define RULE_SET_H
+
+#include <string>
+#include "Hand.h"
+#include "HandHistory.h"
+
+enum class BlackjackPayout { EvenMoney, ThreeToTwo, SixToFive };
+
+constexpr double blackjackMultiple(BlackjackPayout payout) {
+    return payout == BlackjackPayout::ThreeToTwo ? 1.5 : payout == BlackjackPayout::SixToFive ? 1.2 : 1.0;
+}
+
+// House rules as a type. The hand loops are templates over it, so every rule check
+// below is a constant the compiler folds away rather than a branch per hand.
+//
+// With the dealer peeking, a dealer natural ends the round before anyone plays: a
+// player natural pushes, every other hand loses. Without it nobody sees the hole card
+// until the players are done, and the dealer's natural counts as an ordinary 21. A
+// player natural is paid at once either way.
+template <bool HitSoft17, BlackjackPayout Payout, bool Peek>
+struct HouseRules {
+    static constexpr bool hitsSoft17 = HitSoft17;
+    static constexpr BlackjackPayout payout = Payout;
+    static constexpr bool dealerPeeks = Peek;
+    static constexpr double blackjackPays = blackjackMultiple(Payout);
+
+    static bool isNatural(const Hand& hand) { return hand.getSize() == 2 && hand.getTotal() == 21; }
+
+    static bool dealerDraws(const Hand& dealer) {
+        return dealer.getTotal() < 17 || (HitSoft17 && dealer.getTotal() == 17 && dealer.isSoft());
+    }
+
+    // Settles what the initial deal alone decides. Returns false if the player has a decision to make.
+    static bool settleDeal(const Hand& player, const Hand& dealer, HandOutcome& outcome, double& reward) {
+        bool natural = isNatural(player);
+        if (Peek && isNatural(dealer)) {
+            outcome = natural ? HandOutcome::Push : HandOutcome::Loss;
+            reward = natural ? 0.0 : -1.0;
+            return true;
+        }
+        if (!natural) return false;
+        outcome = HandOutcome::Blackjack;
+        reward = blackjackPays;
+        return true;
+    }
+};
+
+// The project's original game: dealer stands on soft 17, naturals pay 1:1, no peek
+using ClassicRules = HouseRules<false, BlackjackPayout::EvenMoney, false>;
+
+// A house's rules at run time, from a preset or a config file of `key = value` lines
+// ('#' starts a comment):
+//   name = downtown
+//   dealer = H17           # or S17
+//   blackjack = 3:2        # or 6:5, 1:1
+//   peek = yes             # or no
+//   decks = 2
+//   penetration = 0.7
+// Missing keys keep the classic values. Errors are reported on std::cerr.
+struct RuleSet {
+    std::string name = "classic";
+    bool hitsSoft17 = false;
+    BlackjackPayout payout = BlackjackPayout::EvenMoney;
+    bool dealerPeeks = false;
+    int decks = 6;
+    double penetration = 0.75;
+
+    double blackjackPays() const { return blackjackMultiple(payout); }
+    // The classic game's rules, whatever the shoe
+    bool isClassic() const { return !hitsSoft17 && payout == BlackjackPayout::EvenMoney && !dealerPeeks; }
+    std::string describe() const; // e.g. "downtown: H17, blackjack pays 3:2, dealer peeks, 2 decks"
+
+    // classic, strip (S17 3:2 peek, 6 decks), downtown (H17 3:2 peek, 2 decks),
+    // six-five (H17 6:5 peek, 6 decks) and european (S17 3:2 no peek, 6 decks)
+    static bool preset(const std::string& name, RuleSet& out);
+    static bool load(const std::string& path, RuleSet& out);
+    // A preset's name, else a config file
+    static bool resolve(const std::string& spec, RuleSet& out);
+};
+
+// The registry from run-time rules to compiled ones: calls f(HouseRules<...>{}) with the
+// instantiation matching `rules`. Every combination is compiled in, so this is the one
+// place a run picks its rules; a new rule is a new template parameter and a level here.
+template <bool HitSoft17, BlackjackPayout Payout, typename F>
+decltype(auto) dispatchPeek(const RuleSet& rules, F&& f) {
+    if (rules.dealerPeeks) return f(HouseRules<HitSoft17, Payout, true>{});
+    return f(HouseRules<HitSoft17, Payout, false>{});
+}
+
+template <bool HitSoft17, typename F>
+decltype(auto) dispatchPayout(const RuleSet& rules, F&& f) {
+    switch (rules.payout) {
+    case BlackjackPayout::ThreeToTwo: return dispatchPeek<HitSoft17, BlackjackPayout::ThreeToTwo>(rules, f);
+    case BlackjackPayout::SixToFive: return dispatchPeek<HitSoft17, BlackjackPayout::SixToFive>(rules, f);
+    case BlackjackPayout::EvenMoney: break;
+    }
+    return dispatchPeek<HitSoft17, BlackjackPayout::EvenMoney>(rules, f);
+}
+
+template <typename F>
+decltype(auto) dispatchRules(const RuleSet& rules, F&& f) {
+    if (rules.hitsSoft17) return dispatchPayout<true>(rules, f);
+    return dispatchPayout<false>(rules, f);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <string>
+
+enum class ScheduleKind {
+    Constant,    // The learner's own epsilon/alpha, untouched
+    Linear,      // start to end over `span` hands, then end
+    Exponential, // From start towards end, halving the gap every `span` hands
+    Visits       // Per state: start * span / (span + visits), down to end
+};
+
+// How QLearner's epsilon or alpha moves during training. Linear and
+// Exponential follow the hands played so far; Visits follows how often the
+// state (for epsilon) or state-action (for alpha) has been seen, so common
+// states settle early while rare ones keep learning.
+struct Schedule {
+    ScheduleKind kind = ScheduleKind::Constant;
+    double start = 0;
+    double end = 0;
+    double span = 1;
+
+    double at(double count) const;
+    bool byHands() const { return kind == ScheduleKind::Linear || kind == ScheduleKind::Exponential; }
+    bool perState() const { return kind == ScheduleKind::Visits; }
+    std::string describe() const;
+
+    // "0.1" (constant), "linear:START:END:HANDS", "exp:START:END:HALF_LIFE_HANDS"
+    // or "visits:START:END:SCALE". Reports the problem and returns false on a bad spec.
+    static bool parse(const std::string& spec, Schedule& out);
+};
+
+#endif
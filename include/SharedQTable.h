@@ -0,0 +1,90 @@
+#ifndef SHARED_QTABLE_H
+#define SHARED_QTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include "AtomicQTable.h"
+
+// Layout of a shared Q-table segment. The first process to attach creates it
+// (ftruncate zero-fills it), writes the layout fields and the starting table,
+// and only then sets `ready`; everyone else waits for that before reading on.
+struct SharedQTableSegment {
+    static constexpr int MAX_MEMBERS = 64;
+
+    char magic[8];            // "BJQSHM01"
+    uint32_t version;
+    uint32_t states;          // QTable::STATES when written
+    uint32_t actions;         // QTable::ACTIONS
+    uint32_t maxMembers;      // MAX_MEMBERS
+    std::atomic<uint32_t> ready;
+    // 0 while open, else the pid of a process that found no one left as it detached;
+    // `closed` is set once that process has made sure and taken the table to persist
+    std::atomic<int32_t> closing;
+    std::atomic<uint32_t> closed;
+    std::atomic<int32_t> members[MAX_MEMBERS]; // Pid of each attached process, 0 for a free slot
+    std::atomic<long long> hands;               // Trained by every process, past and present
+    AtomicQTableStorage table;
+};
+
+// A Q-table in a POSIX shared-memory segment (shm_open + mmap MAP_SHARED) that
+// processes on one machine train together with the same lock-free atomic
+// updates the shared thread mode uses.
+//
+// Processes join and leave at any time. Each holds a member slot with its pid,
+// so the slots of processes that died without leaving are reclaimed by the next
+// join or leave. Persistence is coordinated: the lowest live slot leads and is
+// the only one to checkpoint, and the last process to leave is the only one to
+// save the final table, after which it unlinks the segment. If every process
+// dies instead, the segment (and everything learned) stays until the next one
+// joins it.
+//
+// Errors are reported on std::cerr and attach() returns false.
+class SharedQTable {
+public:
+    SharedQTable() = default;
+    ~SharedQTable(); // Detaches if still attached, then unmaps
+
+    SharedQTable(const SharedQTable&) = delete;
+    SharedQTable& operator=(const SharedQTable&) = delete;
+
+    // Creates `name` ("/blackjack" style; a leading '/' is added if missing) or joins
+    // it. Only the creator calls `seed`, to fill the table before anyone else sees it.
+    bool attach(const std::string& name, const std::function<void(AtomicQTable&)>& seed);
+
+    // Frees this process's slot. Returns true if no live process is left, in which case
+    // the caller owns the table: it persists it, then calls remove().
+    bool detach();
+    // Unlinks the segment so the next attach starts a new one
+    void remove();
+
+    bool isAttached() const { return slot >= 0; }
+    bool created() const { return creator; }
+    int memberSlot() const { return slot; }
+    // Live processes attached right now, this one included
+    int members() const;
+    // True while this process holds the lowest live slot
+    bool leads() const;
+
+    AtomicQTable& table() { return *view; }
+    void addHands(long long hands) { segment->hands.fetch_add(hands, std::memory_order_relaxed); }
+    long long handsTrained() const { return segment->hands.load(std::memory_order_relaxed); }
+
+private:
+    std::string name;
+    SharedQTableSegment* segment = nullptr;
+    std::unique_ptr<AtomicQTable> view;
+    int slot = -1;
+    bool creator = false;
+
+    bool map(int fd);
+    void unmap();
+    bool claimSlot();
+    // Frees the slots of processes that no longer exist
+    void reapDead() const;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SHOE_H
+#define SHOE_H
+
+#include <algorithm>
+#include <vector>
+#include "Card.h"
+#include "Random.h"
+
+// A casino shoe of several decks dealt across many hands. A cut card placed
+// at the penetration point marks when the shoe should be reshuffled; that
+// happens between rounds in prepareRound(), never in the middle of a hand: a
+// round that still runs the shoe out deals on from its reshuffled discards, so
+// the cards on the table never come round again.
+class Shoe {
+private:
+    std::vector<Card> cards; // Allocated once; dealing only moves `next`
+    int next = 0;
+    int roundStart = 0;   // First card of the round in play; the ones before it are discards
+    int cutCard = 0;
+    int runningCount = 0; // Hi-Lo count of every card dealt since the last shuffle
+    int decks;
+    bool lazyShuffle;
+    Rng rng;
+
+    void reshuffleDiscards();
+
+public:
+    // Cards prepareRound keeps back for each hand at the table, the dealer's included.
+    // Nearly every hand takes fewer, so a round almost never reaches the end of the shoe.
+    static constexpr int RESERVE_PER_HAND = 6;
+
+    // lazyShuffle skips the up-front shuffle and instead picks each card at
+    // random from the undealt part of the shoe as it is drawn.
+    Shoe(int numDecks = 6, double penetration = 0.75, bool lazyShuffle = false,
+         Rng rng = streamRng(STREAM_PLAY_SHOE));
+    void shuffle();
+    Card dealCard();
+    bool needsShuffle() const { return next >= cutCard; }
+    // Reshuffles if the cut card has come out, or if fewer than RESERVE_PER_HAND cards are
+    // left for each of `seats` hands and the dealer's; returns true if it did
+    bool prepareRound(int seats = 1);
+    int cardsRemaining() const { return static_cast<int>(cards.size()) - next; }
+    int getDecks() const { return decks; }
+
+    int getRunningCount() const { return runningCount; }
+    // Running count per deck still to be dealt. The last half deck counts as half a deck
+    // so the value stays bounded right before a reshuffle.
+    double getTrueCount() const { return runningCount * 52.0 / std::max(cardsRemaining(), 26); }
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef TABLE_SIMULATOR_H
+#define TABLE_SIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "QLearner.h"
+#include "QTable.h"
+#include "Trainer.h"
+
+// A blackjack table of up to MAX_SEATS players sharing one shoe. Cards go round
+// the table as in a casino (one to each seat, one to the dealer, then the second
+// round), every seat plays its hand in turn, and the dealer plays once for the
+// whole round, so each learner seat gets an episode out of every round while the
+// shuffle and the dealer's cards are paid for once.
+enum class SeatKind {
+    Learner, // Explores and learns with Q-learning updates, one transition stream per seat
+    Fixed,   // Greedy on a fixed Q-table, or hits below a fixed total
+    Recorded // Takes the hits recorded in a hand-history log, one recorded hand per round
+};
+
+struct Seat {
+    SeatKind kind = SeatKind::Learner;
+    QLearner* learner = nullptr;    // Learner: the QLearner it trains; seats may share one
+    const QTable* policy = nullptr; // Fixed: the table it plays greedily...
+    int standOn = 17;               // ...or, without one, the total it stops hitting at
+    std::vector<uint8_t> hits;      // Recorded: hits taken in each recorded hand, replayed in a loop
+    size_t nextRecord = 0;
+
+    // Filled in by runTableTrainer
+    long long hands = 0;
+    double reward = 0;
+
+    const char* kindName() const;
+};
+
+struct TableStats {
+    long long rounds = 0;
+    long long episodes = 0;  // Hands played by learner seats
+    long long seatHands = 0; // Hands played by every seat
+    double seconds = 0;
+    double episodesPerSecond = 0;
+};
+
+constexpr int MAX_SEATS = 7;
+
+// Parses a comma-separated seat list: "learner", "fixed" or "fixed:N" (hit below N,
+// default 17), "policy" (greedy on `policy`) and "recorded:FILE" (a hand-history log).
+// Learner seats all train `learner`. Reports problems on std::cerr and returns false.
+bool parseSeats(const std::string& spec, QLearner& learner, const QTable* policy, std::vector<Seat>& seats);
+
+// Plays rounds until the learner seats have played `episodes` hands between them.
+// Dealing and exploration use the single-threaded trainer's streams and each round
+// keeps the same per-hand reserve (Shoe::prepareRound), so one learner seat alone
+// plays exactly the hands runSilentTrainer would. Checkpoints and hand
+// history work as in the trainer; telemetry and early stopping do not apply.
+TableStats runTableTrainer(std::vector<Seat>& seats, long long episodes, const TrainerConfig& config);
+
+// Per-seat hands and EV of a finished run
+void printTableStats(std::ostream& out, const std::vector<Seat>& seats, const TableStats& stats);
+
+// Trains fresh copies of `prototype` for `episodes` episodes each: once with the
+// single-seat trainer, then at tables of 1..MAX_SEATS learner seats. Prints
+// episodes/sec, the speed-up over the single-seat path and the exact EV of each policy.
+void compareTableSeats(std::ostream& out, const QLearner& prototype, long long episodes, const TrainerConfig& config);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class TelemetryFormat {
+    Csv,      // Header line, then one row per window
+    JsonLines // One JSON object per line
+};
+
+// One window of training as the trainer measured it. Rates, |dQ| and the
+// phase times cover this window only; hands and seconds are running totals.
+struct TelemetrySample {
+    long long hands = 0;
+    double seconds = 0;
+    long long windowHands = 0;
+    double handsPerSecond = 0;
+    double winRate = 0;
+    double pushRate = 0;
+    double lossRate = 0;
+    long long updates = 0;      // Online Q updates (replayed batches are not counted)
+    double meanAbsDeltaQ = 0;   // Mean |change| per online update
+    int statesKnown = 0;
+    double epsilon = 0;
+    double alpha = 0;
+    // Estimated from a sample of the hands (see TELEMETRY_TIMING_SAMPLE in Trainer.cpp)
+    double simulateSeconds = 0; // Dealing, deciding and bookkeeping
+    double updateSeconds = 0;   // Q updates, including replay
+    double persistSeconds = 0;  // Checkpoint snapshots, history flushes, shadow merges
+};
+
+// Writes samples to a file on its own thread, so the trainer only ever copies
+// a sample into a queue; the thread drains it every 100ms. The format follows the extension (.json/.jsonl give
+// JSON lines, anything else CSV); "-" writes CSV to stdout, bypassing std::cout, so
+// main sends all other output to stderr. Each batch goes out in a single write.
+class TelemetryWriter {
+public:
+    explicit TelemetryWriter(const std::string& path);
+    TelemetryWriter(const std::string& path, TelemetryFormat format);
+    ~TelemetryWriter(); // Writes whatever is still queued, then stops
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    bool isOpen() const { return open; }
+    void submit(const TelemetrySample& sample);
+    long long samplesWritten() const;
+
+    static TelemetryFormat formatFor(const std::string& path);
+
+private:
+    void run();
+    void write(std::ostream& out, const TelemetrySample& s); // Appends one row
+    void emit(const std::string& text);
+
+    TelemetryFormat format;
+    std::ofstream file;
+    bool toStdout = false;
+    bool open = false;
+    std::vector<TelemetrySample> pending;
+    bool stopping = false;
+    long long written = 0;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread writer;
+};
+
+#endif
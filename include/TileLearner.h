@@ -0,0 +1,94 @@
+#ifndef TILE_LEARNER_H
+#define TILE_LEARNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "CountLearner.h"
+#include "CountQTable.h"
+#include "Random.h"
+#include "Trainer.h"
+
+class QTableStore;
+
+// Hashed tile coding over CountState's raw features: player total, dealer
+// up-card, soft flag and true count. Each of the TILINGS tilings lays a grid
+// over some of the features, shifted by its own offset, and the cell the state
+// falls in is hashed into one shared table of 2^bits weight pairs ([stand, hit]).
+// Q(s, a) is the sum of the weights of the TILINGS cells.
+//
+// The first half of the tilings ignores the count and learns the basic play
+// from every hand; the second half adds the count on a coarser grid and learns
+// how it shifts that play. The table's size is fixed by `bits`, so a new
+// feature adds tilings, not a factor to the table size.
+//
+// The AVX2 kernel computes all the cells' hashes in two vectors and gathers
+// their weights; CPUs without AVX2 run a scalar kernel with the same float
+// operations in the same order, so both give identical values.
+class TileCoder {
+public:
+    static constexpr int TILINGS = 16;
+    static constexpr int FEATURES = 4; // Total, up-card, soft, true count bucket
+
+    explicit TileCoder(int bits = 12);
+
+    int getBits() const { return bits; }
+    size_t weightCount() const { return size_t(1) << bits; } // Weight pairs
+
+    // Index of each tiling's cell in the weight table
+    void tiles(const CountState& s, uint32_t out[TILINGS]) const;
+    // Q(s, stand) and Q(s, hit) from `weights`, laid out [stand, hit] per cell
+    void values(const float* weights, const uint32_t tiles[TILINGS], double q[2]) const;
+
+    void setUseAvx2(bool enabled);
+    bool usingAvx2() const { return useAvx2; }
+
+private:
+    int bits;
+    bool useAvx2;
+    // Per feature and tiling: cell = floor(x * scale + offset); scale 0 leaves the feature out
+    alignas(32) float scale[FEATURES][TILINGS];
+    alignas(32) float offset[FEATURES][TILINGS];
+};
+
+// Linear Q-learner over TileCoder features, trained like CountLearner on a
+// persistent shoe. Each weight learns at 1 / (TILINGS * its visits) down to
+// alpha / TILINGS, so a state seen for the first time jumps straight to its
+// target, as a table entry with a running mean would.
+class TileLearner {
+public:
+    explicit TileLearner(int bits = 12);
+
+    TileCoder coder;
+    std::vector<float> weights;   // [stand, hit] per cell
+    std::vector<uint32_t> visits; // Per weight
+    double alpha = 0.002;
+    double gamma = 1.0;
+    double epsilon = 0.1;
+    Rng rng = streamRng(STREAM_TILE_EXPLORE);
+
+    int decide(const CountState& s, bool training = true);
+    void update(const CountState& s, int action, double reward, const CountState& nextS, bool isDone);
+    void qValues(const CountState& s, double q[2]) const;
+
+    // Fills a CountQTable with Q(s, a) for every state, to grade or evaluate the policy
+    void exportPolicy(CountQTable& table) const;
+    size_t memoryBytes() const;
+
+    // Stored in the Q-table's database under "tiles-<bits>"; a missing entry loads nothing
+    bool save(QTableStore& store) const;
+    bool load(QTableStore& store);
+};
+
+// Same shoe, seed stream and hand loop as runCountTrainer
+void runTileTrainer(TileLearner& ai, long long hands, const TrainerConfig& config);
+
+// Trains the tile learner and the tabular count-aware learner from scratch at
+// `stages` doubling hand counts ending at `hands`, evaluates each policy over
+// `evalHands`, and prints EV by training size next to each learner's memory.
+// `trained` (optional) receives the tile learner of the last stage.
+void compareTileLearner(std::ostream& out, long long hands, int stages, long long evalHands, int bits,
+                        const TrainerConfig& config, TileLearner* trained = nullptr);
+
+#endif
@@ -1,8 +1,80 @@
 #ifndef TRAINER_H
 #define TRAINER_H
 
+#include <iostream>
+#include "LearnerAlgorithms.h"
 #include "QLearner.h"
+#include "RuleSet.h"
 
-void runSilentTrainer(QLearner& qLearner, int episodes);
+class QTableCheckpointer;
+class HandHistoryWriter;
+class TelemetryWriter;
+class SharedQTable;
 
-#endif
\ No newline at end of file
+// How worker threads share what they learn in runParallelTrainer
+enum class TrainerSync {
+    Shadow, // Each thread trains a private copy, merged into the master at sync points
+    Shared  // All threads update one table in place with lock-free atomic updates
+};
+
+struct TrainerConfig {
+    LearnerAlgorithm algorithm = LearnerAlgorithm::QLearning; // Anything else trains single-threaded
+    RuleSet rules; // Dealer, payout and peek rules; decks and penetration below size the shoe
+    std::ostream* log = &std::cout; // Progress and summary lines; nullptr trains quietly
+    int threads = 1;
+    TrainerSync sync = TrainerSync::Shadow;
+    int syncInterval = 5000; // Hands each thread plays between shadow merges
+    int decks = 6;            // Each thread deals from its own persistent shoe
+    double penetration = 0.75;
+    bool lazyShuffle = false;
+    QTableCheckpointer* checkpointer = nullptr; // Receives a snapshot every checkpointInterval hands
+    int checkpointInterval = 50000;
+    HandHistoryWriter* history = nullptr; // Receives every training hand when set
+    TelemetryWriter* telemetry = nullptr; // Receives a sample every telemetryInterval hands
+    int telemetryInterval = 10000;       // In shadow mode, rounded up to whole sync rounds
+    // Experience replay (single-threaded trainer only): every transition also goes into a
+    // buffer of this many, and replayBatches batches of replayBatchSize are replayed per hand
+    int replayCapacity = 0;
+    int replayBatchSize = 32;
+    int replayBatches = 1;
+    double replayRate = 0.005; // Each transition is replayed ~30 times, so it gets a small step
+    bool replayPrioritized = false;
+    // Early stopping, checked every stopCheckInterval hands (off unless one rule is set).
+    // Training ends when the greedy action changed in at most stopPolicyTolerance of the
+    // known states for stopPatience checks running, or when the mean |dQ| per update
+    // over a check window falls below stopDeltaQ.
+    int stopCheckInterval = 10000;
+    int stopPatience = 0;
+    double stopPolicyTolerance = 0;
+    double stopDeltaQ = 0;
+};
+
+struct TrainerStats {
+    long long hands = 0;    // Played, which is fewer than asked for when training converged
+    long long budget = 0;   // Asked for
+    bool converged = false;
+    double seconds = 0;
+    double handsPerSecond = 0;
+};
+
+// config.log, or a stream that drops everything when it is nullptr. Every trainer prints through it.
+std::ostream& trainerLog(const TrainerConfig& config);
+
+TrainerStats runSilentTrainer(QLearner& qLearner, long long episodes, const TrainerConfig& config = TrainerConfig());
+
+// Splits the episodes across config.threads worker threads.
+// Tolerance: the greedy policy matches a single-threaded run as closely as two
+// single-threaded runs match each other. With alpha = 0.1 and 250k hands that is
+// 75-90% agreement on player totals 12-20; the rest are near-tie states.
+TrainerStats runParallelTrainer(QLearner& qLearner, long long episodes, const TrainerConfig& config);
+
+// Trains Q-learning on an attached shared-memory table, alongside whichever other
+// processes are attached to it, on config.threads threads of this process (shared
+// mode, so hands-based schedules only). Each process deals from its own streams.
+// Every process may pass a checkpointer: leadership is checked at each checkpoint, and
+// only the segment's leader at that moment submits. The table is copied into qLearner
+// at the end.
+TrainerStats runSharedMemoryTrainer(QLearner& qLearner, long long episodes, const TrainerConfig& config,
+                                    SharedQTable& shared);
+
+#endif
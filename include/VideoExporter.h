@@ -0,0 +1,43 @@
+#ifndef VIDEO_EXPORTER_H
+#define VIDEO_EXPORTER_H
+
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "QTable.h"
+
+struct VideoConfig {
+    std::string file = "blackjack_session.avi";
+    int hands = 1000;
+    double fps = 30;
+    int framesPerState = 8;   // Video frames each table state stays on screen
+    int framesPerResult = 30; // ... and each end-of-hand result
+    int decks = 6;
+    double penetration = 0.75;
+    int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    size_t snapshotQueue = 4096; // Table states waiting to be drawn
+    size_t frameQueue = 32;      // Drawn frames waiting to be encoded; also the frame pool size
+};
+
+struct VideoStats {
+    int hands = 0;
+    long long frames = 0;        // Frames written to the video, repeats included
+    long long composed = 0;      // Distinct frames drawn
+    double seconds = 0;
+    double framesPerSecond = 0;  // Sustained encode rate over the whole export
+    size_t simulationStalls = 0; // Times the simulation found the snapshot queue full
+    size_t composeStalls = 0;    // Times composition waited for the encoder to free a frame
+};
+
+// Records the greedy policy playing `config.hands` hands to a video file
+// without opening a window. Three threads form a bounded pipeline:
+//
+//   simulation --(table snapshots)--> composition --(frames)--> encoding
+//
+// The simulation only records snapshots, so it runs far ahead of the
+// encoder; composition draws each snapshot with an offscreen Renderer into a
+// frame from a fixed pool; encoding writes frames (repeated to hold them on
+// screen) and returns them to the pool. No frame is allocated after startup.
+// Returns stats with frames == 0 if the video file could not be opened.
+VideoStats exportVideo(const QTable& policy, const VideoConfig& config);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef WORK_SHARE_H
+#define WORK_SHARE_H
+
+// Hands for worker t when `total` is split as evenly as possible across `threads`:
+// the first total % threads workers take one more
+inline long long shareOf(long long total, int threads, int t) {
+    return total / threads + (t < total % threads ? 1 : 0);
+}
+
+#endif
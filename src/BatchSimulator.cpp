@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <array>
+#include "BatchSimulator.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BATCH_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Hand state: hard total in bits 0-4, "holds an ace" in bit 5
+constexpr int STATES = BatchSimulator::HAND_STATES;
+constexpr int ACE_BIT = 32;
+constexpr int CARD_STRIDE = 16; // Row width of NEXT; card values 1-10 index it directly
+
+struct TransitionTables {
+    std::array<int32_t, STATES * CARD_STRIDE> next{};
+    std::array<int32_t, STATES> total{};
+};
+
+constexpr TransitionTables makeTransitionTables() {
+    TransitionTables t{};
+    for (int s = 0; s < STATES; ++s) {
+        int hard = s & 31;
+        bool ace = (s & ACE_BIT) != 0;
+        t.total[s] = (ace && hard + 10 <= 21) ? hard + 10 : hard;
+        for (int v = 1; v <= 10; ++v) {
+            int nextHard = std::min(hard + v, 31);
+            t.next[s * CARD_STRIDE + v] = nextHard | ((ace || v == 1) ? ACE_BIT : 0);
+        }
+    }
+    return t;
+}
+
+constexpr TransitionTables TRANSITIONS = makeTransitionTables();
+
+// The AVX2 kernel computes transitions arithmetically; check that matches the tables
+constexpr bool formulasMatchTables() {
+    for (int s = 0; s < STATES; ++s) {
+        int hard = s & 31;
+        if (TRANSITIONS.total[s] != hard + (((s & ACE_BIT) && hard < 12) ? 10 : 0)) return false;
+        for (int v = 1; v <= 10; ++v) {
+            int expected = std::min(hard + v, 31) | (s & ACE_BIT) | (v == 1 ? ACE_BIT : 0);
+            if (TRANSITIONS.next[s * CARD_STRIDE + v] != expected) return false;
+        }
+    }
+    return true;
+}
+static_assert(formulasMatchTables(), "AVX2 transition formulas must match the tables");
+
+// Soft 17 is an ace plus a hard 6 (the ace counted as 1 in the hard total)
+constexpr int32_t SOFT_17 = ACE_BIT | 7;
+static_assert(TRANSITIONS.total[SOFT_17] == 17, "SOFT_17 must total 17");
+
+template <typename Rules>
+bool dealerDraws(int32_t state) {
+    return TRANSITIONS.total[state] < 17 || (Rules::hitsSoft17 && state == SOFT_17);
+}
+
+// ---------------------------------------------------------------------------
+// Scalar kernel. Every step advances all LANES (16) lane generators, exactly like the
+// vector kernel, so the two stay in lockstep draw for draw.
+
+struct ScalarLanes {
+    uint32_t* s0;
+    uint32_t* s1;
+    uint32_t* s2;
+    uint32_t* s3;
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    // xoshiro128** step for one lane, mapped to a card value 1-10 (ace = 1)
+    int32_t drawValue(int l) {
+        uint32_t result = rotl(s1[l] * 5, 7) * 9;
+        uint32_t t = s1[l] << 9;
+        s2[l] ^= s0[l];
+        s3[l] ^= s1[l];
+        s1[l] ^= s2[l];
+        s0[l] ^= s3[l];
+        s2[l] ^= t;
+        s3[l] = rotl(s3[l], 11);
+
+        int32_t rank = static_cast<int32_t>(((result >> 8) * 13) >> 24); // 0-12, bias below 2^-24
+        return std::min(rank + 1, 10);
+    }
+};
+
+template <typename Rules>
+void playScalar(BatchSimulator::LaneBlock& block, const BatchSimulator::Tables& tables,
+                long long rounds, BatchResult& result) {
+    constexpr int L = BatchSimulator::LANES;
+    const int32_t* next = TRANSITIONS.next.data();
+    const int32_t* total = TRANSITIONS.total.data();
+    ScalarLanes rng{block.s0, block.s1, block.s2, block.s3};
+
+    for (long long r = 0; r < rounds; ++r) {
+        int32_t player[L], dealer[L], upCard[L];
+        bool active[L], standing[L];
+
+        // Initial Deal (player, dealer up, player, dealer hole)
+        int32_t card[L];
+        for (int l = 0; l < L; ++l) card[l] = rng.drawValue(l);
+        for (int l = 0; l < L; ++l) player[l] = next[card[l]];
+        for (int l = 0; l < L; ++l) card[l] = rng.drawValue(l);
+        for (int l = 0; l < L; ++l) {
+            dealer[l] = next[card[l]];
+            upCard[l] = card[l] == 1 ? 11 : card[l];
+        }
+        for (int l = 0; l < L; ++l) card[l] = rng.drawValue(l);
+        for (int l = 0; l < L; ++l) player[l] = next[player[l] * CARD_STRIDE + card[l]];
+        for (int l = 0; l < L; ++l) card[l] = rng.drawValue(l);
+        for (int l = 0; l < L; ++l) dealer[l] = next[dealer[l] * CARD_STRIDE + card[l]];
+
+        // Blackjack wins immediately, unless the dealer peeks and has one too
+        bool any = false;
+        for (int l = 0; l < L; ++l) {
+            bool natural = total[player[l]] == 21;
+            standing[l] = false;
+            if (Rules::dealerPeeks && total[dealer[l]] == 21) {
+                result.pushes += natural ? 1 : 0;
+                result.losses += natural ? 0 : 1;
+                active[l] = false;
+                continue;
+            }
+            result.wins += natural ? 1 : 0;
+            result.blackjacks += natural ? 1 : 0;
+            active[l] = !natural;
+            any |= active[l];
+        }
+
+        // Player's Turn
+        while (any) {
+            for (int l = 0; l < L; ++l) card[l] = rng.drawValue(l);
+            any = false;
+            for (int l = 0; l < L; ++l) {
+                if (!active[l]) continue;
+                if (tables.policy[upCard[l] * STATES + player[l]] == 0) {
+                    active[l] = false;
+                    standing[l] = true;
+                    continue;
+                }
+                player[l] = next[player[l] * CARD_STRIDE + card[l]];
+                if ((player[l] & 31) > 21) {
+                    result.losses++;
+                    active[l] = false;
+                }
+                any |= active[l];
+            }
+        }
+
+        // Dealer's Turn (only matters for hands still standing)
+        bool drawing[L];
+        any = false;
+        for (int l = 0; l < L; ++l) {
+            drawing[l] = standing[l] && dealerDraws<Rules>(dealer[l]);
+            any |= drawing[l];
+        }
+        while (any) {
+            for (int l = 0; l < L; ++l) card[l] = rng.drawValue(l);
+            any = false;
+            for (int l = 0; l < L; ++l) {
+                if (!drawing[l]) continue;
+                dealer[l] = next[dealer[l] * CARD_STRIDE + card[l]];
+                drawing[l] = dealerDraws<Rules>(dealer[l]);
+                any |= drawing[l];
+            }
+        }
+
+        // Settle
+        for (int l = 0; l < L; ++l) {
+            if (!standing[l]) continue;
+            int32_t p = total[player[l]];
+            int32_t d = total[dealer[l]];
+            if ((dealer[l] & 31) > 21 || p > d) result.wins++;
+            else if (p < d) result.losses++;
+            else result.pushes++;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 kernel: the scalar kernel above with each `for (l ...)` loop turned
+// into 8-lane vector operations.
+
+#ifdef BATCH_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2"))) inline __m256i rotl32(__m256i x, int k) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, k), _mm256_srli_epi32(x, 32 - k));
+}
+
+struct Avx2Lanes {
+    __m256i s0, s1, s2, s3;
+
+    __attribute__((target("avx2"))) __m256i drawValue() {
+        __m256i x5 = _mm256_add_epi32(s1, _mm256_slli_epi32(s1, 2));
+        __m256i rot = rotl32(x5, 7);
+        __m256i result = _mm256_add_epi32(rot, _mm256_slli_epi32(rot, 3));
+        __m256i t = _mm256_slli_epi32(s1, 9);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = rotl32(s3, 11);
+
+        __m256i scaled = _mm256_mullo_epi32(_mm256_srli_epi32(result, 8), _mm256_set1_epi32(13));
+        __m256i rank = _mm256_srli_epi32(scaled, 24);
+        return _mm256_min_epi32(_mm256_add_epi32(rank, _mm256_set1_epi32(1)), _mm256_set1_epi32(10));
+    }
+};
+
+// NEXT and TOTAL are cheap enough to evaluate in registers, which beats a
+// gather; the static_asserts below pin these formulas to the tables.
+__attribute__((target("avx2"))) inline __m256i lookupNext(__m256i state, __m256i card) {
+    __m256i hard = _mm256_min_epi32(_mm256_add_epi32(_mm256_and_si256(state, _mm256_set1_epi32(31)), card),
+                                    _mm256_set1_epi32(31));
+    __m256i ace = _mm256_or_si256(_mm256_and_si256(state, _mm256_set1_epi32(ACE_BIT)),
+                                  _mm256_and_si256(_mm256_cmpeq_epi32(card, _mm256_set1_epi32(1)),
+                                                   _mm256_set1_epi32(ACE_BIT)));
+    return _mm256_or_si256(hard, ace);
+}
+
+__attribute__((target("avx2"))) inline __m256i lookupTotal(__m256i state) {
+    __m256i hard = _mm256_and_si256(state, _mm256_set1_epi32(31));
+    __m256i hasAce = _mm256_cmpeq_epi32(_mm256_and_si256(state, _mm256_set1_epi32(ACE_BIT)),
+                                        _mm256_set1_epi32(ACE_BIT));
+    __m256i soft = _mm256_and_si256(hasAce, _mm256_cmpgt_epi32(_mm256_set1_epi32(12), hard));
+    return _mm256_add_epi32(hard, _mm256_and_si256(soft, _mm256_set1_epi32(10)));
+}
+
+// All-ones in the lanes where the dealer takes another card
+template <typename Rules>
+__attribute__((target("avx2"))) inline __m256i dealerDrawMask(__m256i state) {
+    __m256i draws = _mm256_cmpgt_epi32(_mm256_set1_epi32(17), lookupTotal(state));
+    if (Rules::hitsSoft17) draws = _mm256_or_si256(draws, _mm256_cmpeq_epi32(state, _mm256_set1_epi32(SOFT_17)));
+    return draws;
+}
+
+__attribute__((target("avx2"))) inline long long sumLanes(__m256i counts) {
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+    long long sum = 0;
+    for (uint32_t n : lanes) sum += n;
+    return sum;
+}
+
+template <typename Rules>
+__attribute__((target("avx2")))
+void playAvx2(BatchSimulator::LaneBlock& block, const BatchSimulator::Tables& tables,
+              long long rounds, BatchResult& result) {
+    // Two independent vectors per step: while one waits on a gather the other computes
+    constexpr int V = BatchSimulator::LANES / 8;
+    Avx2Lanes rng[V];
+    for (int v = 0; v < V; ++v) {
+        rng[v] = Avx2Lanes{_mm256_load_si256(reinterpret_cast<const __m256i*>(block.s0 + 8 * v)),
+                           _mm256_load_si256(reinterpret_cast<const __m256i*>(block.s1 + 8 * v)),
+                           _mm256_load_si256(reinterpret_cast<const __m256i*>(block.s2 + 8 * v)),
+                           _mm256_load_si256(reinterpret_cast<const __m256i*>(block.s3 + 8 * v))};
+    }
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i eleven = _mm256_set1_epi32(11);
+    const __m256i twentyOne = _mm256_set1_epi32(21);
+    const __m256i hardMask = _mm256_set1_epi32(31);
+    const __m256i seven = _mm256_set1_epi32(7);
+    const __m256i policyLow = _mm256_load_si256(reinterpret_cast<const __m256i*>(tables.policyBits));
+    const __m256i policyHigh = _mm256_load_si256(reinterpret_cast<const __m256i*>(tables.policyBits + 8));
+
+    // Outcome tallies stay in registers: subtracting an all-ones mask adds 1 per lane
+    __m256i wins = zero, pushes = zero, losses = zero, blackjacks = zero;
+
+    for (long long r = 0; r < rounds; ++r) {
+        __m256i player[V], dealer[V], hitMask[V], active[V], standing[V], card[V];
+
+        // Initial Deal (player, dealer up, player, dealer hole)
+        for (int v = 0; v < V; ++v) {
+            card[v] = rng[v].drawValue();
+            player[v] = lookupNext(zero, card[v]);
+            card[v] = rng[v].drawValue();
+            dealer[v] = lookupNext(zero, card[v]);
+            __m256i upCard = _mm256_blendv_epi8(card[v], eleven, _mm256_cmpeq_epi32(card[v], one));
+            // The up-card is fixed for the hand, so fetch its policy row once
+            __m256i low = _mm256_permutevar8x32_epi32(policyLow, upCard);
+            __m256i high = _mm256_permutevar8x32_epi32(policyHigh, upCard);
+            hitMask[v] = _mm256_blendv_epi8(low, high, _mm256_cmpgt_epi32(upCard, seven));
+            card[v] = rng[v].drawValue();
+            player[v] = lookupNext(player[v], card[v]);
+            card[v] = rng[v].drawValue();
+            dealer[v] = lookupNext(dealer[v], card[v]);
+        }
+
+        // Blackjack wins immediately, unless the dealer peeks and has one too
+        __m256i any = zero;
+        for (int v = 0; v < V; ++v) {
+            __m256i natural = _mm256_cmpeq_epi32(lookupTotal(player[v]), twentyOne);
+            __m256i settled = natural;
+            if (Rules::dealerPeeks) {
+                __m256i dealerNatural = _mm256_cmpeq_epi32(lookupTotal(dealer[v]), twentyOne);
+                pushes = _mm256_sub_epi32(pushes, _mm256_and_si256(dealerNatural, natural));
+                losses = _mm256_sub_epi32(losses, _mm256_andnot_si256(natural, dealerNatural));
+                natural = _mm256_andnot_si256(dealerNatural, natural);
+                settled = _mm256_or_si256(settled, dealerNatural);
+            }
+            wins = _mm256_sub_epi32(wins, natural);
+            blackjacks = _mm256_sub_epi32(blackjacks, natural);
+            active[v] = _mm256_andnot_si256(settled, _mm256_set1_epi32(-1));
+            standing[v] = zero;
+            any = _mm256_or_si256(any, active[v]);
+        }
+
+        // Player's Turn
+        while (!_mm256_testz_si256(any, any)) {
+            any = zero;
+            for (int v = 0; v < V; ++v) {
+                card[v] = rng[v].drawValue();
+                __m256i action = _mm256_and_si256(_mm256_srlv_epi32(hitMask[v], lookupTotal(player[v])), one);
+                __m256i stand = _mm256_and_si256(active[v], _mm256_cmpeq_epi32(action, zero));
+                standing[v] = _mm256_or_si256(standing[v], stand);
+                __m256i hit = _mm256_andnot_si256(stand, active[v]);
+
+                player[v] = _mm256_blendv_epi8(player[v], lookupNext(player[v], card[v]), hit);
+                __m256i bust = _mm256_and_si256(hit, _mm256_cmpgt_epi32(_mm256_and_si256(player[v], hardMask), twentyOne));
+                losses = _mm256_sub_epi32(losses, bust);
+                active[v] = _mm256_andnot_si256(bust, hit);
+                any = _mm256_or_si256(any, active[v]);
+            }
+        }
+
+        // Dealer's Turn (only matters for hands still standing)
+        __m256i drawing[V];
+        for (int v = 0; v < V; ++v) {
+            drawing[v] = _mm256_and_si256(standing[v], dealerDrawMask<Rules>(dealer[v]));
+            any = _mm256_or_si256(any, drawing[v]);
+        }
+        while (!_mm256_testz_si256(any, any)) {
+            any = zero;
+            for (int v = 0; v < V; ++v) {
+                card[v] = rng[v].drawValue();
+                dealer[v] = _mm256_blendv_epi8(dealer[v], lookupNext(dealer[v], card[v]), drawing[v]);
+                drawing[v] = _mm256_and_si256(drawing[v], dealerDrawMask<Rules>(dealer[v]));
+                any = _mm256_or_si256(any, drawing[v]);
+            }
+        }
+
+        // Settle
+        for (int v = 0; v < V; ++v) {
+            __m256i p = lookupTotal(player[v]);
+            __m256i d = lookupTotal(dealer[v]);
+            __m256i dealerBust = _mm256_cmpgt_epi32(_mm256_and_si256(dealer[v], hardMask), twentyOne);
+            __m256i win = _mm256_and_si256(standing[v], _mm256_or_si256(dealerBust, _mm256_cmpgt_epi32(p, d)));
+            __m256i lose = _mm256_andnot_si256(win, _mm256_and_si256(standing[v], _mm256_cmpgt_epi32(d, p)));
+            __m256i push = _mm256_andnot_si256(_mm256_or_si256(win, lose), standing[v]);
+            wins = _mm256_sub_epi32(wins, win);
+            losses = _mm256_sub_epi32(losses, lose);
+            pushes = _mm256_sub_epi32(pushes, push);
+        }
+    }
+
+    result.wins += sumLanes(wins);
+    result.pushes += sumLanes(pushes);
+    result.losses += sumLanes(losses);
+    result.blackjacks += sumLanes(blackjacks);
+
+    for (int v = 0; v < V; ++v) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block.s0 + 8 * v), rng[v].s0);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block.s1 + 8 * v), rng[v].s1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block.s2 + 8 * v), rng[v].s2);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block.s3 + 8 * v), rng[v].s3);
+    }
+}
+
+#endif
+
+} // namespace
+
+BatchSimulator::BatchSimulator(const QTable& policy, uint64_t streamId, int lanes, const RuleSet& rules)
+    : rules(rules), blocks(std::max(1, (lanes + LANES - 1) / LANES)), useAvx2(hasAvx2()) {
+    // Freeze the greedy policy the same way QLearner::decide(s, false) reads it
+    for (int up = 0; up < QTable::DEALER_CARDS; ++up) {
+        for (int s = 0; s < HAND_STATES; ++s) {
+            const double* q = policy.at(State{TRANSITIONS.total[s], up, false});
+            tables.policy[up * HAND_STATES + s] = (q[1] > q[0]) ? 1 : 0;
+        }
+    }
+    for (int up = 0; up < 16; ++up) {
+        tables.policyBits[up] = 0;
+        for (int total = 0; up < QTable::DEALER_CARDS && total < QTable::TOTALS; ++total) {
+            const double* q = policy.at(State{total, up, false});
+            if (q[1] > q[0]) tables.policyBits[up] |= 1u << total;
+        }
+    }
+
+    Rng seeder = streamRng(streamId);
+    for (auto& block : blocks) {
+        for (int l = 0; l < LANES; ++l) {
+            // xoshiro128** must not start from all zeroes; forcing s0 odd rules it out
+            block.s0[l] = static_cast<uint32_t>(seeder()) | 1;
+            block.s1[l] = static_cast<uint32_t>(seeder());
+            block.s2[l] = static_cast<uint32_t>(seeder());
+            block.s3[l] = static_cast<uint32_t>(seeder());
+        }
+    }
+}
+
+bool BatchSimulator::hasAvx2() {
+#ifdef BATCH_HAVE_AVX2_KERNEL
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+BatchResult BatchSimulator::run(long long hands) {
+    BatchResult result;
+    result.blackjackPays = rules.blackjackPays();
+    long long groups = static_cast<long long>(blocks.size());
+    long long totalRounds = (hands + LANES - 1) / LANES;
+
+    for (long long g = 0; g < groups; ++g) {
+        // Spread the rounds over the blocks; the first ones take the remainder
+        long long rounds = totalRounds / groups + (g < totalRounds % groups ? 1 : 0);
+        if (rounds == 0) continue;
+        dispatchRules(rules, [&](auto houseRules) {
+            using Rules = decltype(houseRules);
+#ifdef BATCH_HAVE_AVX2_KERNEL
+            if (useAvx2) {
+                playAvx2<Rules>(blocks[g], tables, rounds, result);
+                return;
+            }
+#endif
+            playScalar<Rules>(blocks[g], tables, rounds, result);
+        });
+        result.hands += rounds * LANES;
+    }
+    return result;
+}
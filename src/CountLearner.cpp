@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "CountLearner.h"
+#include "Hand.h"
+#include "Shoe.h"
+#include "WorkShare.h"
+
+namespace {
+
+double bucketEV(const CountEvalResult& r, int b) {
+    return r.handsByBucket[b] > 0 ? r.returnByBucket[b] / r.handsByBucket[b] : 0;
+}
+
+double bucketError(const CountEvalResult& r, int b) {
+    long long n = r.handsByBucket[b];
+    if (n < 2) return 0;
+    double mean = r.returnByBucket[b] / n;
+    double variance = (static_cast<double>(r.decisiveByBucket[b]) / n - mean * mean) * n / (n - 1);
+    return std::sqrt(std::max(0.0, variance) / n);
+}
+
+} // namespace
+
+int CountLearner::decide(const CountState& s, bool training) {
+    if (training && rng.uniform() < epsilon) {
+        return static_cast<int>(rng.below(2));
+    }
+    return qTable.greedyAction(s);
+}
+
+void CountLearner::update(const CountState& s, int action, double reward, const CountState& nextS, bool isDone) {
+    double maxNextQ = 0;
+    if (!isDone) {
+        const double* next = qTable.at(nextS);
+        maxNextQ = std::max(next[0], next[1]);
+    }
+    int i = CountQTable::index(s);
+    double* q = qTable.at(i);
+    uint32_t& n = visits[i * CountQTable::ACTIONS + action];
+    if (n < UINT32_MAX) ++n;
+    double rate = std::max(alpha, 1.0 / n);
+    q[action] += rate * (reward + gamma * maxNextQ - q[action]);
+    qTable.markKnown(i);
+}
+
+void runCountTrainer(CountLearner& ai, long long hands, const TrainerConfig& config) {
+    std::ostream& log = trainerLog(config);
+    log << "Training " << (ai.useCount ? "count-aware" : "count-blind") << " AI for " << hands
+              << " hands on a " << config.decks << "-deck shoe..." << std::endl;
+    Shoe shoe(config.decks, config.penetration, config.lazyShuffle, streamRng(STREAM_COUNT_SHOE));
+    auto decide = [&ai](const CountState& s) { return ai.decide(s, true); };
+    auto learn = [&ai](const CountState& s, int action, double reward, const CountState& nextS, bool isDone) {
+        ai.update(s, action, reward, nextS, isDone);
+    };
+    int bucket;
+    for (long long i = 0; i < hands; ++i) playCountHand(shoe, ai.useCount, decide, learn, bucket);
+    log << "Training complete. States known: " << ai.qTable.size() << std::endl;
+}
+
+CountEvalResult evaluateCountPolicy(const CountQTable& policy, bool useCount, long long hands, int decks,
+                                    double penetration, int threads) {
+    threads = std::max(1, threads);
+    std::vector<CountEvalResult> partial(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        long long share = shareOf(hands, threads, t);
+        workers.emplace_back([&policy, &partial, useCount, share, decks, penetration, t]() {
+            Shoe shoe(decks, penetration, false, streamRng(STREAM_COUNT_EVAL + t));
+            CountEvalResult& r = partial[t];
+            auto decide = [&policy](const CountState& s) { return policy.greedyAction(s); };
+            auto ignore = [](const CountState&, int, double, const CountState&, bool) {};
+            int bucket;
+            for (long long i = 0; i < share; ++i) {
+                double reward = playCountHand(shoe, useCount, decide, ignore, bucket);
+                r.handsByBucket[bucket]++;
+                r.returnByBucket[bucket] += reward;
+                r.decisiveByBucket[bucket] += reward != 0 ? 1 : 0;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    CountEvalResult result;
+    double total = 0;
+    long long decisive = 0;
+    for (const auto& p : partial) {
+        for (int b = 0; b < CountQTable::COUNT_BUCKETS; ++b) {
+            result.handsByBucket[b] += p.handsByBucket[b];
+            result.returnByBucket[b] += p.returnByBucket[b];
+            result.decisiveByBucket[b] += p.decisiveByBucket[b];
+            result.hands += p.handsByBucket[b];
+            total += p.returnByBucket[b];
+            decisive += p.decisiveByBucket[b];
+        }
+    }
+    long long n = result.hands;
+    if (n > 1) {
+        result.ev = total / n;
+        double variance = (static_cast<double>(decisive) / n - result.ev * result.ev) * n / (n - 1);
+        result.stdError = std::sqrt(std::max(0.0, variance) / n);
+    }
+    result.seconds = elapsed.count();
+    return result;
+}
+
+void printCountComparison(std::ostream& out, const CountEvalResult& aware, const CountEvalResult& blind,
+                          const CountQTable& policy) {
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << std::fixed << std::setprecision(4);
+    out << "Overall EV:  count-aware " << aware.ev << " +/- " << aware.stdError << ", count-blind " << blind.ev
+        << " +/- " << blind.stdError << " (" << aware.hands << " hands each)" << std::endl;
+    out << "True count   share     aware EV     blind EV   difference" << std::endl;
+    for (int b = 0; b < CountQTable::COUNT_BUCKETS; ++b) {
+        if (aware.handsByBucket[b] == 0) continue;
+        double diff = bucketEV(aware, b) - bucketEV(blind, b);
+        double diffError = std::hypot(bucketError(aware, b), bucketError(blind, b));
+        out << std::setw(6) << std::showpos << CountQTable::countOf(b) << std::noshowpos
+            << (b == 0 || b == CountQTable::COUNT_BUCKETS - 1 ? "+ " : "  ") << std::setw(9)
+            << static_cast<double>(aware.handsByBucket[b]) / aware.hands << std::setw(13) << bucketEV(aware, b)
+            << std::setw(13) << bucketEV(blind, b) << std::setw(13) << diff << " +/- " << diffError << std::endl;
+    }
+
+    // Where the learned play at each count departs from its own play at a count of 0
+    out << "Deviations from the true-count-0 play (hard 12-16):" << std::endl;
+    for (int b = 0; b < CountQTable::COUNT_BUCKETS; ++b) {
+        if (b == CountQTable::NEUTRAL_BUCKET) continue;
+        out << "  TC " << std::showpos << CountQTable::countOf(b) << std::noshowpos << ":";
+        int shown = 0;
+        for (int total = 12; total <= 16; ++total) {
+            for (int dealer = 2; dealer <= 11; ++dealer) {
+                CountState here = {total, dealer, false, b};
+                CountState neutral = {total, dealer, false, CountQTable::NEUTRAL_BUCKET};
+                if (!policy.isKnown(CountQTable::index(here))) continue;
+                int action = policy.greedyAction(here);
+                if (action == policy.greedyAction(neutral)) continue;
+                out << " " << total << "v" << (dealer == 11 ? "A" : std::to_string(dealer)) << (action ? ":H" : ":S");
+                ++shown;
+            }
+        }
+        if (shown == 0) out << " none";
+        out << std::endl;
+    }
+    out << std::setprecision(2) << "Time:        " << aware.seconds + blind.seconds << " s" << std::endl;
+    out.copyfmt(oldState);
+}
@@ -0,0 +1,132 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "DealerOdds.h"
+
+namespace {
+
+// Card values 1-10 (ace = 1); tens include the three face cards
+constexpr double INFINITE_DECK_P[11] = {0, 1.0 / 13, 1.0 / 13, 1.0 / 13, 1.0 / 13, 1.0 / 13,
+                                        1.0 / 13, 1.0 / 13, 1.0 / 13, 1.0 / 13, 4.0 / 13};
+
+int softTotal(int hard, bool ace) {
+    return (ace && hard + 10 <= 21) ? hard + 10 : hard;
+}
+
+DealerDistribution finished(int total) {
+    DealerDistribution d{};
+    d[total > 21 ? DEALER_BUST : total - 17] = 1.0;
+    return d;
+}
+
+void accumulate(DealerDistribution& into, const DealerDistribution& from, double p) {
+    for (int i = 0; i < DEALER_OUTCOMES; ++i) into[i] += p * from[i];
+}
+
+// Infinite deck: the future only depends on (hard total, holds an ace)
+class InfiniteDealer {
+private:
+    std::map<std::pair<int, bool>, DealerDistribution> memo;
+
+public:
+    DealerDistribution from(int hard, bool ace) {
+        int total = softTotal(hard, ace);
+        if (total >= 17) return finished(total);
+
+        auto key = std::make_pair(hard, ace);
+        auto it = memo.find(key);
+        if (it != memo.end()) return it->second;
+
+        DealerDistribution d{};
+        for (int v = 1; v <= 10; ++v) accumulate(d, from(hard + v, ace || v == 1), INFINITE_DECK_P[v]);
+        memo[key] = d;
+        return d;
+    }
+};
+
+// Finite shoe: the future depends on which cards the dealer has drawn. The
+// drawn multiset also fixes the hard total and ace flag, so it alone is the key.
+class ShoeDealer {
+private:
+    std::array<int, 11> remaining{}; // By card value 1-10
+    int remainingTotal = 0;
+    int upValue;
+    std::array<int, 11> drawn{};
+    std::unordered_map<uint64_t, DealerDistribution> memo;
+
+    uint64_t key() const {
+        uint64_t k = 0;
+        for (int v = 1; v <= 10; ++v) k = (k << 5) | static_cast<uint64_t>(drawn[v]);
+        return k;
+    }
+
+public:
+    ShoeDealer(int decks, int up) : upValue(up) {
+        for (int v = 1; v <= 10; ++v) remaining[v] = decks * (v == 10 ? 16 : 4);
+        remaining[up]--;
+        for (int v = 1; v <= 10; ++v) remainingTotal += remaining[v];
+    }
+
+    DealerDistribution from(int hard, bool ace) {
+        int total = softTotal(hard, ace);
+        if (total >= 17) return finished(total);
+
+        uint64_t k = key();
+        auto it = memo.find(k);
+        if (it != memo.end()) return it->second;
+
+        DealerDistribution d{};
+        for (int v = 1; v <= 10; ++v) {
+            if (remaining[v] == 0) continue;
+            double p = static_cast<double>(remaining[v]) / remainingTotal;
+            remaining[v]--;
+            remainingTotal--;
+            drawn[v]++;
+            accumulate(d, from(hard + v, ace || v == 1), p);
+            drawn[v]--;
+            remainingTotal++;
+            remaining[v]++;
+        }
+        memo[k] = d;
+        return d;
+    }
+
+    DealerDistribution start() { return from(upValue, upValue == 1); }
+};
+
+} // namespace
+
+DealerOdds::DealerOdds(int numDecks) : decks(numDecks) {
+    InfiniteDealer infinite;
+    for (int up = 2; up <= 11; ++up) {
+        int card = (up == 11) ? 1 : up;
+        if (decks <= 0) {
+            byUpCard[up] = infinite.from(card, card == 1);
+        } else {
+            ShoeDealer shoe(decks, card);
+            byUpCard[up] = shoe.start();
+        }
+    }
+}
+
+const DealerOdds& DealerOdds::get(int decks) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<DealerOdds>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& odds = cache[decks < 0 ? 0 : decks];
+    if (!odds) odds.reset(new DealerOdds(decks < 0 ? 0 : decks));
+    return *odds;
+}
+
+double DealerOdds::standEV(int playerTotal, int upValue) const {
+    const DealerDistribution& d = byUpCard[upValue];
+    double ev = d[DEALER_BUST];
+    for (int total = 17; total <= 21; ++total) {
+        double p = d[total - 17];
+        if (playerTotal > total) ev += p;
+        else if (playerTotal < total) ev -= p;
+    }
+    return ev;
+}
@@ -1,10 +1,9 @@
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
-#include <random>
-#include <chrono>
 #include "Card.h"
 #include "Deck.h"
+#include "Random.h"
 
 Deck::Deck() {
     for (int s = static_cast<int>(Suit::SPADES); s <= static_cast<int>(Suit::CLUBS); ++s) {
@@ -15,8 +14,10 @@ Deck::Deck() {
 }
 
 void Deck::shuffle() {
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle(cards.begin(), cards.end(), std::default_random_engine(seed));
+    Rng& rng = threadRng();
+    for (int i = static_cast<int>(cards.size()) - 1; i > 0; --i) {
+        std::swap(cards[i], cards[rng.below(i + 1)]);
+    }
 }
 
 Card Deck::dealCard() {
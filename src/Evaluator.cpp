@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include "BatchSimulator.h"
+#include "Evaluator.h"
+#include "Random.h"
+#include "WorkShare.h"
+
+namespace {
+
+constexpr double Z_95 = 1.959963984540054;
+
+double rate(long long count, long long hands) {
+    return hands > 0 ? static_cast<double>(count) / hands : 0;
+}
+
+} // namespace
+
+EvalResult evaluatePolicy(const QTable& qTable, long long hands, int threads, const RuleSet& rules) {
+    threads = std::max(1, threads);
+    std::vector<BatchResult> partial(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        long long share = shareOf(hands, threads, t);
+        workers.emplace_back([&qTable, &rules, &partial, t, share]() {
+            BatchSimulator sim(qTable, STREAM_BATCH + t, 2048, rules);
+            if (share > 0) partial[t] = sim.run(share);
+        });
+    }
+    for (auto& w : workers) w.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    EvalResult result;
+    result.threads = threads;
+    result.avx2 = BatchSimulator::hasAvx2();
+    for (const auto& p : partial) {
+        result.hands += p.hands;
+        result.wins += p.wins;
+        result.pushes += p.pushes;
+        result.losses += p.losses;
+        result.blackjacks += p.blackjacks;
+    }
+
+    // Returns are -1, 0, +1 or the blackjack payout, so the sum of squares needs only the counts
+    long long n = result.hands;
+    double pays = rules.blackjackPays();
+    if (n > 0) {
+        long long evenWins = result.wins - result.blackjacks;
+        result.ev = (evenWins - result.losses + result.blackjacks * pays) / n;
+        double meanSq = (evenWins + result.losses + result.blackjacks * pays * pays) / n;
+        double variance = n > 1 ? (meanSq - result.ev * result.ev) * n / (n - 1) : 0;
+        result.stdError = std::sqrt(std::max(0.0, variance) / n);
+    }
+    result.ciLow = result.ev - Z_95 * result.stdError;
+    result.ciHigh = result.ev + Z_95 * result.stdError;
+    result.seconds = elapsed.count();
+    result.handsPerSecond = result.seconds > 0 ? n / result.seconds : 0;
+    return result;
+}
+
+void printEvalResult(std::ostream& out, const EvalResult& r) {
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << std::fixed << std::setprecision(4);
+    out << "Hands:       " << r.hands << " on " << r.threads << " threads"
+        << (r.avx2 ? " (AVX2)" : " (scalar)") << std::endl;
+    out << "EV:          " << r.ev << " per hand, 95% CI [" << r.ciLow << ", " << r.ciHigh << "]" << std::endl;
+    out << "Win/Push/Loss: " << rate(r.wins, r.hands) << " / " << rate(r.pushes, r.hands) << " / "
+        << rate(r.losses, r.hands) << std::endl;
+    out << std::setprecision(2) << "Time:        " << r.seconds << " s, "
+        << static_cast<long long>(r.handsPerSecond) << " hands/sec" << std::endl;
+    out.copyfmt(oldState);
+}
+
+void writeEvalJson(std::ostream& out, const EvalResult& r) {
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << std::setprecision(10);
+    out << "{\n"
+        << "  \"seed\": " << getMasterSeed() << ",\n"
+        << "  \"threads\": " << r.threads << ",\n"
+        << "  \"avx2\": " << (r.avx2 ? "true" : "false") << ",\n"
+        << "  \"hands\": " << r.hands << ",\n"
+        << "  \"wins\": " << r.wins << ",\n"
+        << "  \"pushes\": " << r.pushes << ",\n"
+        << "  \"losses\": " << r.losses << ",\n"
+        << "  \"blackjacks\": " << r.blackjacks << ",\n"
+        << "  \"win_rate\": " << rate(r.wins, r.hands) << ",\n"
+        << "  \"push_rate\": " << rate(r.pushes, r.hands) << ",\n"
+        << "  \"loss_rate\": " << rate(r.losses, r.hands) << ",\n"
+        << "  \"ev\": " << r.ev << ",\n"
+        << "  \"std_error\": " << r.stdError << ",\n"
+        << "  \"ci95\": [" << r.ciLow << ", " << r.ciHigh << "],\n"
+        << "  \"seconds\": " << r.seconds << ",\n"
+        << "  \"hands_per_second\": " << r.handsPerSecond << "\n"
+        << "}" << std::endl;
+    out.copyfmt(oldState);
+}
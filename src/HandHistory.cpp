@@ -0,0 +1,365 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "HandHistory.h"
+#include "RuleSet.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'B', 'J', 'H', 'A', 'N', 'D', 'S', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t SESSION_BYTES = 12;
+constexpr int CARD_BITS = 6;
+
+HandHistoryHeader makeHeader() {
+    HandHistoryHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(HandHistoryHeader);
+    return header;
+}
+
+std::string checkHeader(const HandHistoryHeader& header) {
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return "not a hand-history file";
+    if (header.version != VERSION) return "unsupported version " + std::to_string(header.version);
+    if (header.headerSize < sizeof(HandHistoryHeader)) return "bad header size";
+    return "";
+}
+
+size_t handBytes(int playerCards, int dealerCards) {
+    return 2 + ((playerCards + dealerCards) * CARD_BITS + 7) / 8;
+}
+
+// Six-bit codes of the first eight cards, packed into the low 48 bits without a loop
+uint64_t packEight(const Card* cards) {
+    uint64_t x;
+    std::memcpy(&x, cards, sizeof(x));
+    x = (x & 0x003F003F003F003FULL) | ((x & 0x3F003F003F003F00ULL) >> 2);
+    x = (x & 0x00000FFF00000FFFULL) | ((x & 0x0FFF00000FFF0000ULL) >> 4);
+    return (x & 0xFFFFFFULL) | ((x >> 8) & 0xFFFFFF000000ULL);
+}
+
+uint64_t lowBits(int count) {
+    return (1ULL << count) - 1;
+}
+
+// Byte 3 of a session record
+uint8_t encodeRules(const RuleSet& rules) {
+    return static_cast<uint8_t>(static_cast<int>(rules.payout) | (rules.dealerPeeks ? 0x04 : 0) |
+                                (rules.hitsSoft17 ? 0x08 : 0));
+}
+
+double rate(long long count, long long total) {
+    return total > 0 ? static_cast<double>(count) / total : 0;
+}
+
+} // namespace
+
+void HandHistoryBlock::beginSession(HistorySource source, uint64_t seed, int decks, const RuleSet& rules) {
+    uint8_t* record = tail(SESSION_BYTES);
+    record[0] = 0;
+    record[1] = static_cast<uint8_t>(source);
+    record[2] = static_cast<uint8_t>(decks);
+    record[3] = encodeRules(rules);
+    for (int i = 0; i < 8; ++i) record[4 + i] = static_cast<uint8_t>(seed >> (8 * i));
+    used += SESSION_BYTES;
+}
+
+void HandHistoryBlock::record(const Hand& player, const Hand& dealer, HandOutcome outcome, bool reshuffled) {
+    int playerCards = player.getSize();
+    int dealerCards = dealer.getSize();
+
+    // Written straight into the block; the 8 spare bytes absorb the whole-word stores below
+    uint8_t* encoded = tail(2 + (2 * Hand::MAX_CARDS * CARD_BITS + 7) / 8 + 8);
+    encoded[0] = static_cast<uint8_t>(playerCards | (static_cast<int>(outcome) << 5) | (reshuffled ? 0x80 : 0));
+    encoded[1] = static_cast<uint8_t>(dealerCards);
+    size_t size = 2 + ((playerCards + dealerCards) * CARD_BITS + 7) / 8;
+
+    if (playerCards + dealerCards <= 10 && playerCards <= 8 && dealerCards <= 8) {
+        // Nearly every hand: both hands fit in one 64-bit word
+        uint64_t packed = (packEight(player.cardData()) & lowBits(playerCards * CARD_BITS)) |
+                          ((packEight(dealer.cardData()) & lowBits(dealerCards * CARD_BITS)) << (playerCards * CARD_BITS));
+        std::memcpy(encoded + 2, &packed, sizeof(packed)); // Little-endian, like the rest of the format
+    } else {
+        uint64_t pending = 0;
+        int bits = 0;
+        uint8_t* outPtr = encoded + 2;
+        auto put = [&](Card card) {
+            pending |= static_cast<uint64_t>(card.getCode()) << bits;
+            bits += CARD_BITS;
+            std::memcpy(outPtr, &pending, sizeof(pending));
+            outPtr += bits >> 3;
+            pending >>= bits & ~7;
+            bits &= 7;
+        };
+        for (int i = 0; i < playerCards; ++i) put(player.cardData()[i]);
+        for (int i = 0; i < dealerCards; ++i) put(dealer.cardData()[i]);
+        if (bits > 0) *outPtr = static_cast<uint8_t>(pending);
+    }
+    used += size;
+    ++handCount;
+}
+
+HandHistoryWriter::HandHistoryWriter(const std::string& path, size_t bufferBytes)
+    : path(path), bufferBytes(bufferBytes) {
+    // An existing log is appended to, but only if it really is one
+    struct stat info;
+    bool exists = stat(path.c_str(), &info) == 0 && info.st_size > 0;
+    if (exists) {
+        std::ifstream in(path, std::ios::binary);
+        HandHistoryHeader header{};
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        std::string problem = in ? checkHeader(header) : "file too small";
+        if (!problem.empty()) {
+            std::cerr << "Cannot append to " << path << ": " << problem << std::endl;
+            return;
+        }
+
+        // A run killed mid-flush leaves a torn record; appending after it would hide every later session
+        size_t whole = 0;
+        {
+            HandHistoryReader reader(path);
+            if (!reader.isOpen()) return;
+            HandRecord hand;
+            while (reader.next(hand)) {}
+            if (reader.isTruncated()) whole = reader.bytesRead();
+        }
+        if (whole > 0) {
+            std::error_code error;
+            std::filesystem::resize_file(path, whole, error);
+            if (error) {
+                std::cerr << "Cannot append to " << path << ": it ends in a torn record that could not be cut off ("
+                          << error.message() << ")" << std::endl;
+                return;
+            }
+            std::cerr << path << " ended in a torn record; cut off " << info.st_size - static_cast<off_t>(whole)
+                      << " bytes before appending" << std::endl;
+        }
+    }
+
+    out.open(path, std::ios::binary | std::ios::app);
+    if (!out) {
+        std::cerr << "Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    if (!exists) {
+        HandHistoryHeader header = makeHeader();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    buffer.tail(bufferBytes + BLOCK_BYTES);
+    open = static_cast<bool>(out);
+}
+
+HandHistoryWriter::~HandHistoryWriter() {
+    flush();
+}
+
+void HandHistoryWriter::beginSession(HistorySource source, uint64_t seed, int decks, const RuleSet& rules) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.beginSession(source, seed, decks, rules);
+}
+
+void HandHistoryWriter::record(const Hand& player, const Hand& dealer, HandOutcome outcome, bool reshuffled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.record(player, dealer, outcome, reshuffled);
+    if (buffer.size() >= bufferBytes) flushLocked();
+}
+
+void HandHistoryWriter::append(const HandHistoryBlock& block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::memcpy(buffer.tail(block.used), block.bytes.data(), block.used);
+    buffer.used += block.used;
+    buffer.handCount += block.handCount;
+    if (buffer.size() >= bufferBytes) flushLocked();
+}
+
+bool HandHistoryWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!flushLocked()) return false;
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+long long HandHistoryWriter::handsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hands + buffer.hands();
+}
+
+bool HandHistoryWriter::flushLocked() {
+    if (!open) {
+        buffer.clear();
+        return false;
+    }
+    if (buffer.size() > 0) {
+        out.write(reinterpret_cast<const char*>(buffer.bytes.data()), static_cast<std::streamsize>(buffer.size()));
+        if (!out) {
+            std::cerr << "Could not write " << path << "; hand history stopped" << std::endl;
+            open = false;
+        }
+    }
+    hands += buffer.hands();
+    buffer.clear();
+    return open;
+}
+
+HandHistoryReader::HandHistoryReader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(HandHistoryHeader)) {
+        std::cerr << "Could not read " << path << ": file too small" << std::endl;
+        close(fd);
+        return;
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Could not map " << path << ": " << std::strerror(errno) << std::endl;
+        mapping = nullptr;
+        return;
+    }
+    // One pass front to back: read ahead aggressively, let pages go once they are behind us
+    madvise(mapping, length, MADV_SEQUENTIAL);
+
+    HandHistoryHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    std::string problem = checkHeader(header);
+    if (!problem.empty()) {
+        std::cerr << "Cannot read " << path << ": " << problem << std::endl;
+        munmap(mapping, length);
+        mapping = nullptr;
+        return;
+    }
+    offset = header.headerSize;
+}
+
+HandHistoryReader::~HandHistoryReader() {
+    if (mapping) munmap(mapping, length);
+}
+
+bool HandHistoryReader::next(HandRecord& hand) {
+    const auto* data = static_cast<const uint8_t*>(mapping);
+    while (mapping && offset < length) {
+        const uint8_t* record = data + offset;
+        size_t left = length - offset;
+
+        if (record[0] == 0) {
+            if (left < SESSION_BYTES) break;
+            source = static_cast<HistorySource>(record[1]);
+            decks = record[2];
+            rules = record[3];
+            seed = 0;
+            for (int i = 0; i < 8; ++i) seed |= static_cast<uint64_t>(record[4 + i]) << (8 * i);
+            ++sessions;
+            offset += SESSION_BYTES;
+            continue;
+        }
+
+        int playerCards = record[0] & 0x1F;
+        int dealerCards = left >= 2 ? record[1] & 0x1F : 0;
+        if (playerCards < 2 || dealerCards < 2 || playerCards > Hand::MAX_CARDS || dealerCards > Hand::MAX_CARDS) break;
+        size_t size = handBytes(playerCards, dealerCards);
+        if (left < size) break;
+
+        hand.player = Hand();
+        hand.dealer = Hand();
+        uint32_t pending = 0;
+        int bits = 0;
+        const uint8_t* cards = record + 2;
+        bool valid = true;
+        for (int i = 0; i < playerCards + dealerCards; ++i) {
+            while (bits < CARD_BITS) {
+                pending |= static_cast<uint32_t>(*cards++) << bits;
+                bits += 8;
+            }
+            uint8_t code = static_cast<uint8_t>(pending & ((1u << CARD_BITS) - 1));
+            pending >>= CARD_BITS;
+            bits -= CARD_BITS;
+            if (!Card::isValidCode(code)) valid = false;
+            (i < playerCards ? hand.player : hand.dealer).addCard(Card::fromCode(code));
+        }
+        if (!valid) break;
+
+        hand.outcome = static_cast<HandOutcome>((record[0] >> 5) & 0x03);
+        hand.reshuffled = (record[0] & 0x80) != 0;
+        hand.source = source;
+        hand.seed = seed;
+        hand.decks = decks;
+        hand.blackjackPays = blackjackMultiple(static_cast<BlackjackPayout>(rules & 0x03));
+        hand.dealerPeeks = (rules & 0x04) != 0;
+        hand.hitsSoft17 = (rules & 0x08) != 0;
+        offset += size;
+        return true;
+    }
+    if (mapping && offset < length) truncated = true;
+    return false;
+}
+
+HandHistoryStats scanHandHistory(HandHistoryReader& reader) {
+    auto start = std::chrono::steady_clock::now();
+    HandHistoryStats stats;
+    HandRecord hand;
+    while (reader.next(hand)) {
+        ++stats.hands;
+        if (hand.source == HistorySource::Training) ++stats.trainingHands;
+        switch (hand.outcome) {
+            case HandOutcome::Win: ++stats.wins; break;
+            case HandOutcome::Push: ++stats.pushes; break;
+            case HandOutcome::Loss: ++stats.losses; break;
+            case HandOutcome::Blackjack: ++stats.blackjacks; break;
+        }
+        if (hand.player.isBust()) ++stats.playerBusts;
+        if (hand.dealer.isBust()) ++stats.dealerBusts;
+        if (hand.reshuffled) ++stats.reshuffles;
+        if (hand.outcome != HandOutcome::Blackjack && hand.settledAtDeal()) ++stats.dealerPeeks;
+        stats.hits += hand.player.getSize() - 2;
+
+        double reward = hand.reward();
+        int upcard = hand.dealer.getCard(0).getValue();
+        stats.totalReward += reward;
+        stats.handsByUpcard[upcard]++;
+        stats.rewardByUpcard[upcard] += reward;
+    }
+    stats.sessions = reader.sessionCount();
+    stats.truncated = reader.isTruncated();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
+
+void printHandHistoryStats(std::ostream& out, const HandHistoryStats& s) {
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << std::fixed << std::setprecision(4);
+    out << "Sessions:    " << s.sessions << std::endl;
+    out << "Hands:       " << s.hands << " (" << s.trainingHands << " training, "
+        << s.hands - s.trainingHands << " play)" << std::endl;
+    out << "EV:          " << (s.hands > 0 ? s.totalReward / s.hands : 0) << " per hand" << std::endl;
+    out << "Win/Push/Loss/Natural: " << rate(s.wins, s.hands) << " / " << rate(s.pushes, s.hands) << " / "
+        << rate(s.losses, s.hands) << " / " << rate(s.blackjacks, s.hands) << std::endl;
+    out << "Player busts: " << rate(s.playerBusts, s.hands) << ", dealer busts: " << rate(s.dealerBusts, s.hands)
+        << ", hits per hand: " << rate(s.hits, s.hands) << ", reshuffles: " << s.reshuffles << std::endl;
+    out << "Ended by the dealer's peek: " << rate(s.dealerPeeks, s.hands) << std::endl;
+    out << "EV by dealer up-card:" << std::endl;
+    for (int upcard = 2; upcard <= 11; ++upcard) {
+        long long n = s.handsByUpcard[upcard];
+        out << "  " << std::setw(2) << upcard << ": " << std::setw(8) << (n > 0 ? s.rewardByUpcard[upcard] / n : 0)
+            << "  (" << n << " hands)" << std::endl;
+    }
+    if (s.truncated) out << "Warning: the log ends in a torn record; everything before it was read" << std::endl;
+    out << std::setprecision(2) << "Time:        " << s.seconds << " s, "
+        << static_cast<long long>(s.seconds > 0 ? s.hands / s.seconds : 0) << " hands/sec" << std::endl;
+    out.copyfmt(oldState);
+}
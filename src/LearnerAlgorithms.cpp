@@ -0,0 +1,83 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "LearnerAlgorithms.h"
+#include "PolicyGrader.h"
+#include "Trainer.h"
+
+namespace {
+
+const LearnerAlgorithm ALL_ALGORITHMS[] = {LearnerAlgorithm::QLearning, LearnerAlgorithm::Sarsa,
+                                           LearnerAlgorithm::ExpectedSarsa, LearnerAlgorithm::DoubleQ,
+                                           LearnerAlgorithm::MonteCarlo};
+
+} // namespace
+
+const char* algorithmName(LearnerAlgorithm algorithm) {
+    switch (algorithm) {
+    case LearnerAlgorithm::QLearning: return "q";
+    case LearnerAlgorithm::Sarsa: return "sarsa";
+    case LearnerAlgorithm::ExpectedSarsa: return "expected-sarsa";
+    case LearnerAlgorithm::DoubleQ: return "double-q";
+    case LearnerAlgorithm::MonteCarlo: return "monte-carlo";
+    }
+    return "?";
+}
+
+bool parseAlgorithm(const std::string& name, LearnerAlgorithm& out) {
+    for (LearnerAlgorithm algorithm : ALL_ALGORITHMS) {
+        if (name == algorithmName(algorithm)) {
+            out = algorithm;
+            return true;
+        }
+    }
+    std::cerr << "Unknown algorithm \"" << name << "\": expected q, sarsa, expected-sarsa, double-q or monte-carlo"
+              << std::endl;
+    return false;
+}
+
+void compareLearnerAlgorithms(std::ostream& out, const QLearner& prototype, long long hands, const TrainerConfig& config) {
+    // Only the learning is compared: nothing is checkpointed, logged, streamed or printed
+    TrainerConfig quiet;
+    quiet.log = nullptr;
+    quiet.decks = config.decks;
+    quiet.penetration = config.penetration;
+    quiet.lazyShuffle = config.lazyShuffle;
+    quiet.rules = config.rules;
+    quiet.stopCheckInterval = config.stopCheckInterval;
+    quiet.stopPatience = config.stopPatience;
+    quiet.stopPolicyTolerance = config.stopPolicyTolerance;
+    quiet.stopDeltaQ = config.stopDeltaQ;
+
+    struct Row {
+        LearnerAlgorithm algorithm;
+        TrainerStats stats;
+        PolicyGrade grade;
+    };
+    std::vector<Row> rows;
+    for (LearnerAlgorithm algorithm : ALL_ALGORITHMS) {
+        // Every algorithm starts from the same table and draws the same shoe and RNG streams
+        QLearner ai = prototype;
+        quiet.algorithm = algorithm;
+        TrainerStats stats = runSilentTrainer(ai, hands, quiet);
+        rows.push_back({algorithm, stats, gradePolicy(ai.qTable, config.decks)});
+    }
+
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << "\n--- Learner algorithms: " << hands << " training hands each, exact EV of the greedy policy ---\n";
+    out << std::left << std::setw(16) << "Algorithm" << std::right << std::setw(12) << "Hands" << std::setw(14)
+        << "Hands/sec" << std::setw(12) << "EV" << std::setw(10) << "Mistakes" << "\n";
+    out << std::fixed;
+    for (const Row& row : rows) {
+        out << std::left << std::setw(16) << algorithmName(row.algorithm) << std::right << std::setw(12)
+            << row.stats.hands << std::setw(14) << std::setprecision(0) << row.stats.handsPerSecond
+            << std::setw(12) << std::setprecision(4) << row.grade.policyEV << std::setw(10) << row.grade.mistakes
+            << "\n";
+    }
+    if (!rows.empty()) {
+        out << "Optimal hit/stand EV: " << std::setprecision(4) << rows.front().grade.optimalEV << "\n";
+    }
+    out.copyfmt(oldState);
+    out.flush();
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include "DealerOdds.h"
+#include "PolicyGrader.h"
+
+namespace {
+
+constexpr double CARD_P[11] = {0, 1.0 / 13, 1.0 / 13, 1.0 / 13, 1.0 / 13, 1.0 / 13,
+                               1.0 / 13, 1.0 / 13, 1.0 / 13, 1.0 / 13, 4.0 / 13};
+
+int softTotal(int hard, bool ace) {
+    return (ace && hard + 10 <= 21) ? hard + 10 : hard;
+}
+
+// Expected values of player hands (hard total, holds an ace) against one
+// up-card, either following the Q-table or playing optimally.
+class HandValues {
+private:
+    const QTable& qTable;
+    const DealerOdds& odds;
+    int upValue;
+    bool optimal;
+    std::map<std::pair<int, bool>, double> memo;
+
+public:
+    HandValues(const QTable& q, const DealerOdds& d, int up, bool best)
+        : qTable(q), odds(d), upValue(up), optimal(best) {}
+
+    int policyAction(int hard, bool ace) const {
+        // Same key playRound builds: the soft flag is not part of it
+        const double* q = qTable.at(State{softTotal(hard, ace), upValue, false});
+        return (q[1] > q[0]) ? 1 : 0;
+    }
+
+    double standEV(int hard, bool ace) const { return odds.standEV(softTotal(hard, ace), upValue); }
+
+    double hitEV(int hard, bool ace) {
+        double ev = 0;
+        for (int v = 1; v <= 10; ++v) {
+            int nextHard = hard + v;
+            ev += CARD_P[v] * (nextHard > 21 ? -1.0 : value(nextHard, ace || v == 1));
+        }
+        return ev;
+    }
+
+    double value(int hard, bool ace) {
+        auto key = std::make_pair(hard, ace);
+        auto it = memo.find(key);
+        if (it != memo.end()) return it->second;
+
+        double ev;
+        if (optimal) ev = std::max(standEV(hard, ace), hitEV(hard, ace));
+        else ev = policyAction(hard, ace) == 1 ? hitEV(hard, ace) : standEV(hard, ace);
+        memo[key] = ev;
+        return ev;
+    }
+
+    // Whole-hand value: two player cards with a blackjack paying at once
+    double dealtEV() {
+        double ev = 0;
+        for (int a = 1; a <= 10; ++a) {
+            for (int b = 1; b <= 10; ++b) {
+                bool ace = (a == 1 || b == 1);
+                double handEV = (softTotal(a + b, ace) == 21) ? 1.0 : value(a + b, ace);
+                ev += CARD_P[a] * CARD_P[b] * handEV;
+            }
+        }
+        return ev;
+    }
+};
+
+double upCardP(int upValue) {
+    return CARD_P[upValue == 11 ? 1 : upValue];
+}
+
+} // namespace
+
+PolicyGrade gradePolicy(const QTable& qTable, int decks) {
+    const DealerOdds& odds = DealerOdds::get(decks);
+    PolicyGrade grade;
+    grade.decks = odds.getDecks();
+
+    for (int up = 2; up <= 11; ++up) {
+        HandValues policy(qTable, odds, up, false);
+        HandValues best(qTable, odds, up, true);
+        grade.policyEV += upCardP(up) * policy.dealtEV();
+        grade.optimalEV += upCardP(up) * best.dealtEV();
+
+        // Every hand a player can be asked to act on: hard 4-21, soft 12-21
+        for (int soft = 0; soft <= 1; ++soft) {
+            for (int total = soft ? 12 : 4; total <= 21; ++total) {
+                int hard = soft ? total - 10 : total;
+                StateGrade s;
+                s.playerTotal = total;
+                s.soft = soft == 1;
+                s.dealerCard = up;
+                s.standEV = policy.standEV(hard, s.soft);
+                s.hitEV = policy.hitEV(hard, s.soft);
+                s.policyAction = policy.policyAction(hard, s.soft);
+                s.bestAction = s.hitEV > s.standEV ? 1 : 0;
+                if (s.policyAction != s.bestAction) grade.mistakes++;
+                grade.states.push_back(s);
+            }
+        }
+    }
+    return grade;
+}
+
+void printPolicyGrade(std::ostream& out, const PolicyGrade& grade, bool showStates) {
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << std::fixed << std::setprecision(4);
+
+    if (showStates) {
+        const DealerOdds& odds = DealerOdds::get(grade.decks);
+        out << "Up   P(17)  P(18)  P(19)  P(20)  P(21)  P(bust)" << std::endl;
+        for (int up = 2; up <= 11; ++up) {
+            out << std::setw(2) << up;
+            for (double p : odds.forUpCard(up)) out << " " << std::setw(6) << std::setprecision(4) << p;
+            out << std::endl;
+        }
+
+        out << "Hand     vs  Stand EV   Hit EV  Policy  Best" << std::endl;
+        for (const auto& s : grade.states) {
+            out << (s.soft ? "soft " : "hard ") << std::setw(2) << s.playerTotal << "  "
+                << std::setw(4) << s.dealerCard << "  " << std::setw(8) << s.standEV << " "
+                << std::setw(8) << s.hitEV << "  " << (s.policyAction ? "HIT  " : "STAND")
+                << "   " << (s.bestAction ? "HIT  " : "STAND")
+                << (s.policyAction != s.bestAction ? "  <-" : "") << std::endl;
+        }
+    }
+
+    out << "Deck model:  " << (grade.decks == 0 ? std::string("infinite") : std::to_string(grade.decks) + " decks")
+        << std::endl;
+    out << "Policy EV:   " << grade.policyEV << " per hand" << std::endl;
+    out << "Optimal EV:  " << grade.optimalEV << " per hand" << std::endl;
+    out << "EV lost:     " << grade.optimalEV - grade.policyEV << " per hand" << std::endl;
+    out << "Mistakes:    " << grade.mistakes << " of " << grade.states.size() << " hands" << std::endl;
+    out.copyfmt(oldState);
+}
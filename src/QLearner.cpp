@@ -1,80 +1,59 @@
 #include <algorithm>
-#include <random>
-#include <sqlite3.h>
 #include <iostream>
 #include "QLearner.h"
+#include "QTableStore.h"
 
-void QLearner::saveToDatabase(const std::string& filename) {
-    sqlite3* db;
-    if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) return;
-
-    // 1. Create Table and Clear old data
-    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS QTable (pTotal INT, dCard INT, hasAce INT, standQ REAL, hitQ REAL);", 0, 0, 0);
-    sqlite3_exec(db, "DELETE FROM QTable;", 0, 0, 0);
-
-    // 2. Use a Transaction for massive speed boost
-    sqlite3_exec(db, "BEGIN TRANSACTION;", 0, 0, 0);
-
-    const char* sql = "INSERT INTO QTable VALUES (?, ?, ?, ?, ?);";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, 0);
-
-    for (auto const& [state, values] : qTable) {
-        sqlite3_bind_int(stmt, 1, state.pTotal);
-        sqlite3_bind_int(stmt, 2, state.dCard);
-        sqlite3_bind_int(stmt, 3, state.hasAce ? 1 : 0);
-        sqlite3_bind_double(stmt, 4, values[0]); // Stand
-        sqlite3_bind_double(stmt, 5, values[1]); // Hit
-        
-        sqlite3_step(stmt);
-        sqlite3_reset(stmt);
+bool QLearner::saveToDatabase(const std::string& filename) {
+    QTableStore store(filename);
+    if (!store.replace(qTable)) {
+        std::cerr << "Could not save AI knowledge to " << filename << std::endl;
+        return false;
     }
-
-    sqlite3_finalize(stmt);
-    sqlite3_exec(db, "END TRANSACTION;", 0, 0, 0);
-    sqlite3_close(db);
     std::cout << "AI knowledge saved to " << filename << std::endl;
+    return true;
 }
 
-void QLearner::loadFromDatabase(const std::string& filename) {
-    sqlite3* db;
-    if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) return;
-
-    const char* sql = "SELECT * FROM QTable;";
-    sqlite3_stmt* stmt;
-    
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
-        qTable.clear();
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            State s;
-            s.pTotal = sqlite3_column_int(stmt, 0);
-            s.dCard = sqlite3_column_int(stmt, 1);
-            s.hasAce = sqlite3_column_int(stmt, 2) == 1;
-            
-            qTable[s][0] = sqlite3_column_double(stmt, 3);
-            qTable[s][1] = sqlite3_column_double(stmt, 4);
-        }
+bool QLearner::loadFromDatabase(const std::string& filename) {
+    QTableStore store(filename);
+    if (!store.load(qTable)) {
+        std::cerr << "Could not load AI knowledge from " << filename << std::endl;
+        return false;
     }
-    
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
     std::cout << "AI knowledge loaded. States known: " << qTable.size() << std::endl;
+    return true;
 }
 
-int QLearner::decide(State s, bool training) {
-    // Epsilon-greedy: Exploration
-    if (training && ((double)rand() / RAND_MAX < epsilon)) {
-        return rand() % 2; 
+void QLearner::advanceSchedules(long long hands) {
+    if (epsilonSchedule.byHands()) epsilon = epsilonSchedule.at(static_cast<double>(hands));
+    if (alphaSchedule.byHands()) alpha = alphaSchedule.at(static_cast<double>(hands));
+    if ((epsilonSchedule.perState() || alphaSchedule.perState()) && visits.empty()) {
+        visits.assign(QTable::STATES * QTable::ACTIONS, 0);
     }
-    
-    // Exploitation: Choose the best-known move
-    return (qTable[s][1] > qTable[s][0]) ? 1 : 0;
 }
 
-void QLearner::update(State s, int action, double reward, State nextS, bool isDone) {
-    double maxNextQ = isDone ? 0 : std::max(qTable[nextS][0], qTable[nextS][1]);
-    
-    // The Bellman Equation: 
-    // NewQ = OldQ + LearningRate * (Reward + Discount * MaxFutureQ - OldQ)
-    qTable[s][action] += alpha * (reward + gamma * maxNextQ - qTable[s][action]);
-}
\ No newline at end of file
+void QLearner::updateBatch(const Transition* batch, int count, double rate, const float* weights, float* tdErrors) {
+    // Chunks small enough that the targets stay in registers and L1 between the two passes
+    constexpr int CHUNK = 64;
+    double targets[CHUNK];
+    for (int start = 0; start < count; start += CHUNK) {
+        int n = std::min(CHUNK, count - start);
+        const Transition* chunk = batch + start;
+
+        // Pass 1: read-only, every target from the same snapshot of the table
+        for (int j = 0; j < n; ++j) {
+            const double* next = qTable.at(static_cast<int>(chunk[j].next));
+            double maxNextQ = chunk[j].done ? 0 : std::max(next[0], next[1]);
+            targets[j] = chunk[j].reward + gamma * maxNextQ;
+        }
+
+        // Pass 2: apply
+        for (int j = 0; j < n; ++j) {
+            double* q = qTable.at(static_cast<int>(chunk[j].state));
+            double error = targets[j] - q[chunk[j].action];
+            double step = weights ? rate * weights[start + j] : rate;
+            q[chunk[j].action] += step * error;
+            qTable.markKnown(chunk[j].state);
+            if (tdErrors) tdErrors[start + j] = static_cast<float>(error);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "QTableFile.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'B', 'J', 'Q', 'T', 'A', 'B', 'L', 'E'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t ENDIAN_CHECK = 0x01020304;
+
+uint64_t fnv1a(const unsigned char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+QTableFileHeader makeHeader() {
+    QTableFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(QTableFileHeader);
+    header.totals = QTable::TOTALS;
+    header.dealerCards = QTable::DEALER_CARDS;
+    header.states = QTable::STATES;
+    header.actions = QTable::ACTIONS;
+    header.bodySize = sizeof(QTable);
+    header.endianCheck = ENDIAN_CHECK;
+    return header;
+}
+
+// Returns an empty string when the file's header matches this build, else the reason it does not
+std::string checkHeader(const QTableFileHeader& header, size_t fileSize) {
+    QTableFileHeader expected = makeHeader();
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return "not a Q-table file";
+    if (header.version != VERSION) return "unsupported version " + std::to_string(header.version);
+    if (header.endianCheck != ENDIAN_CHECK) return "written on a machine with a different byte order";
+    if (header.headerSize != expected.headerSize || header.totals != expected.totals ||
+        header.dealerCards != expected.dealerCards || header.states != expected.states ||
+        header.actions != expected.actions || header.bodySize != expected.bodySize) {
+        return "written for a different Q-table layout";
+    }
+    if (fileSize < header.headerSize + header.bodySize) return "truncated";
+    return "";
+}
+
+} // namespace
+
+bool writeQTableFile(const std::string& path, const QTable& table) {
+    // The dirty flags only mean something to the process that set them
+    QTable body = table;
+    body.clearDirty();
+
+    QTableFileHeader header = makeHeader();
+    header.checksum = fnv1a(reinterpret_cast<const unsigned char*>(&body), sizeof(QTable));
+
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&body), sizeof(QTable));
+        if (!out) {
+            std::cerr << "Could not write " << temp << std::endl;
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+    // Readers that already mapped the old file keep their pages; new readers see the whole new one
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Could not replace " << path << ": " << std::strerror(errno) << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+MappedQTable::MappedQTable(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(QTableFileHeader)) {
+        std::cerr << "Could not read " << path << ": file too small" << std::endl;
+        close(fd);
+        return;
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Could not map " << path << ": " << std::strerror(errno) << std::endl;
+        mapping = nullptr;
+        return;
+    }
+
+    const auto* header = static_cast<const QTableFileHeader*>(mapping);
+    std::string problem = checkHeader(*header, length);
+    const auto* body = static_cast<const unsigned char*>(mapping) + header->headerSize;
+    if (problem.empty() && fnv1a(body, sizeof(QTable)) != header->checksum) problem = "checksum mismatch";
+    if (!problem.empty()) {
+        std::cerr << "Cannot use " << path << ": " << problem << std::endl;
+        return;
+    }
+    view = std::launder(reinterpret_cast<const QTable*>(body));
+}
+
+MappedQTable::~MappedQTable() {
+    if (mapping) munmap(mapping, length);
+}
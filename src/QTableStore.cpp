@@ -0,0 +1,315 @@
+#include <cstring>
+#include <iostream>
+#include "QTableStore.h"
+
+namespace {
+
+const char* CREATE_TABLE =
+    "CREATE TABLE IF NOT EXISTS QTable (pTotal INT, dCard INT, hasAce INT, standQ REAL, hitQ REAL, "
+    "PRIMARY KEY (pTotal, dCard, hasAce)) WITHOUT ROWID;";
+
+const char* UPSERT_ROW =
+    "INSERT INTO QTable VALUES (?, ?, ?, ?, ?) "
+    "ON CONFLICT (pTotal, dCard, hasAce) DO UPDATE SET standQ = excluded.standQ, hitQ = excluded.hitQ;";
+
+// Tables written before the primary key existed are copied over in rowid
+// order, so if a state appears twice the row written last wins
+const char* MIGRATE_TABLE =
+    "ALTER TABLE QTable RENAME TO QTable_unkeyed;"
+    "CREATE TABLE QTable (pTotal INT, dCard INT, hasAce INT, standQ REAL, hitQ REAL, "
+    "PRIMARY KEY (pTotal, dCard, hasAce)) WITHOUT ROWID;"
+    "INSERT OR REPLACE INTO QTable SELECT pTotal, dCard, hasAce, standQ, hitQ FROM QTable_unkeyed ORDER BY rowid;"
+    "DROP TABLE QTable_unkeyed;";
+
+const char* CREATE_WEIGHTS = "CREATE TABLE IF NOT EXISTS Weights (name TEXT PRIMARY KEY, count INT, data BLOB);";
+
+} // namespace
+
+QTableStore::QTableStore(const std::string& filename) : filename(filename) {
+    if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Could not open " << filename << ": " << (db ? sqlite3_errmsg(db) : "out of memory") << std::endl;
+        sqlite3_close(db);
+        db = nullptr;
+        return;
+    }
+    sqlite3_busy_timeout(db, 5000); // Another process may be mid-checkpoint
+}
+
+QTableStore::~QTableStore() {
+    sqlite3_finalize(upsert);
+    sqlite3_finalize(select);
+    if (db) sqlite3_close(db);
+}
+
+bool QTableStore::check(int rc, const char* what) {
+    if (rc == SQLITE_OK || rc == SQLITE_DONE || rc == SQLITE_ROW) return true;
+    std::cerr << "SQLite error in " << filename << " (" << what << "): " << sqlite3_errmsg(db) << std::endl;
+    return false;
+}
+
+bool QTableStore::exec(const char* sql, const char* what) {
+    return check(sqlite3_exec(db, sql, nullptr, nullptr, nullptr), what);
+}
+
+bool QTableStore::prepareForWrites() {
+    if (!db) return false;
+    if (writable) return true;
+
+    // journal_mode answers with a row instead of an error when WAL is unavailable
+    sqlite3_stmt* wal = nullptr;
+    if (!check(sqlite3_prepare_v2(db, "PRAGMA journal_mode = WAL;", -1, &wal, nullptr), "enable WAL")) return false;
+    if (sqlite3_step(wal) == SQLITE_ROW) {
+        const char* mode = reinterpret_cast<const char*>(sqlite3_column_text(wal, 0));
+        if (!mode || std::strcmp(mode, "wal") != 0) {
+            std::cerr << "Warning: " << filename << " stays in " << (mode ? mode : "unknown") << " journal mode" << std::endl;
+        }
+    }
+    sqlite3_finalize(wal);
+    // Safe with WAL: a crash can lose the last commit but never corrupt the file
+    if (!exec("PRAGMA synchronous = NORMAL;", "set synchronous")) return false;
+
+    // Bring keyless tables from older builds up to the keyed schema
+    sqlite3_stmt* schema = nullptr;
+    if (!check(sqlite3_prepare_v2(db, "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = 'QTable';", -1,
+                                  &schema, nullptr), "read schema")) {
+        return false;
+    }
+    bool needsMigration = false;
+    if (sqlite3_step(schema) == SQLITE_ROW) {
+        const char* sql = reinterpret_cast<const char*>(sqlite3_column_text(schema, 0));
+        needsMigration = sql && std::strstr(sql, "PRIMARY KEY") == nullptr;
+    }
+    sqlite3_finalize(schema);
+
+    if (needsMigration) {
+        if (!exec("BEGIN IMMEDIATE;", "begin migration")) return false;
+        if (!exec(MIGRATE_TABLE, "migrate to keyed schema")) {
+            exec("ROLLBACK;", "roll back migration");
+            return false;
+        }
+        if (!exec("COMMIT;", "commit migration")) return false;
+        std::cout << "Upgraded " << filename << " to the keyed Q-table schema." << std::endl;
+    }
+
+    if (!exec(CREATE_TABLE, "create table")) return false;
+    if (!check(sqlite3_prepare_v2(db, UPSERT_ROW, -1, &upsert, nullptr), "prepare upsert")) return false;
+    writable = true;
+    return true;
+}
+
+bool QTableStore::load(QTable& table) {
+    if (!db) return false;
+    if (!select) {
+        int rc = sqlite3_prepare_v2(db, "SELECT pTotal, dCard, hasAce, standQ, hitQ FROM QTable;", -1, &select, nullptr);
+        if (rc != SQLITE_OK) {
+            // A new file has no table yet; that is an empty Q-table, not an error
+            bool noTable = std::strstr(sqlite3_errmsg(db), "no such table") != nullptr;
+            if (!noTable) check(rc, "prepare select");
+            table.clear();
+            return noTable;
+        }
+    }
+
+    table.clear();
+    int rc;
+    while ((rc = sqlite3_step(select)) == SQLITE_ROW) {
+        State s;
+        s.pTotal = sqlite3_column_int(select, 0);
+        s.dCard = sqlite3_column_int(select, 1);
+        s.hasAce = sqlite3_column_int(select, 2) == 1;
+        if (s.pTotal < 0 || s.pTotal >= QTable::TOTALS || s.dCard < 0 || s.dCard >= QTable::DEALER_CARDS) {
+            continue; // Row outside the state space, cannot come from this trainer
+        }
+
+        double* q = table[s];
+        q[0] = sqlite3_column_double(select, 3);
+        q[1] = sqlite3_column_double(select, 4);
+    }
+    sqlite3_reset(select);
+    table.clearDirty(); // Everything just loaded matches the file
+    return check(rc, "read rows");
+}
+
+bool QTableStore::writeRows(const QTable& table, bool onlyDirty) {
+    lastRows = 0;
+    for (int i = 0; i < QTable::STATES; ++i) {
+        if (!table.isKnown(i) || (onlyDirty && !table.isDirty(i))) continue;
+        State state = QTable::stateAt(i);
+        const double* values = table.at(i);
+        sqlite3_bind_int(upsert, 1, state.pTotal);
+        sqlite3_bind_int(upsert, 2, state.dCard);
+        sqlite3_bind_int(upsert, 3, state.hasAce ? 1 : 0);
+        sqlite3_bind_double(upsert, 4, values[0]); // Stand
+        sqlite3_bind_double(upsert, 5, values[1]); // Hit
+
+        int rc = sqlite3_step(upsert);
+        sqlite3_reset(upsert);
+        if (!check(rc, "write row")) return false;
+        ++lastRows;
+    }
+    return true;
+}
+
+bool QTableStore::saveDirty(QTable& table) {
+    if (!prepareForWrites()) return false;
+    if (!exec("BEGIN IMMEDIATE;", "begin save")) return false;
+    if (!writeRows(table, true) || !exec("COMMIT;", "commit save")) {
+        exec("ROLLBACK;", "roll back save");
+        return false;
+    }
+    table.clearDirty();
+    return true;
+}
+
+bool QTableStore::replace(QTable& table) {
+    if (!prepareForWrites()) return false;
+    if (!exec("BEGIN IMMEDIATE;", "begin save")) return false;
+    if (!exec("DELETE FROM QTable;", "delete rows") || !writeRows(table, false) || !exec("COMMIT;", "commit save")) {
+        exec("ROLLBACK;", "roll back save");
+        return false;
+    }
+    table.clearDirty();
+    return true;
+}
+
+bool QTableStore::clear() {
+    return prepareForWrites() && exec("DELETE FROM QTable;", "delete rows");
+}
+
+bool QTableStore::saveWeights(const std::string& name, const std::vector<float>& weights) {
+    if (!prepareForWrites() || !exec(CREATE_WEIGHTS, "create weights table")) return false;
+    sqlite3_stmt* stmt = nullptr;
+    if (!check(sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO Weights VALUES (?, ?, ?);", -1, &stmt, nullptr),
+               "prepare weights save")) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(weights.size()));
+    sqlite3_bind_blob(stmt, 3, weights.data(), static_cast<int>(weights.size() * sizeof(float)), SQLITE_STATIC);
+    bool ok = check(sqlite3_step(stmt), "save weights");
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+bool QTableStore::loadWeights(const std::string& name, std::vector<float>& weights) {
+    if (!db) return false;
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(db, "SELECT count, data FROM Weights WHERE name = ?;", -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        // Files written before any learner saved weights have no table; nothing is stored
+        if (std::strstr(sqlite3_errmsg(db), "no such table") == nullptr) check(rc, "prepare weights load");
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+    bool found = false;
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        sqlite3_int64 count = sqlite3_column_int64(stmt, 0);
+        const void* data = sqlite3_column_blob(stmt, 1);
+        int bytes = sqlite3_column_bytes(stmt, 1);
+        if (count >= 0 && bytes == count * static_cast<sqlite3_int64>(sizeof(float))) {
+            weights.resize(static_cast<size_t>(count));
+            if (bytes > 0) std::memcpy(weights.data(), data, static_cast<size_t>(bytes));
+            found = true;
+        } else {
+            std::cerr << "Weights \"" << name << "\" in " << filename << " are truncated" << std::endl;
+        }
+    } else {
+        check(rc, "load weights");
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+QTableCheckpointer::QTableCheckpointer(QTableStore& store, bool replaceFirst) : store(store), replacing(replaceFirst) {
+    writer = std::thread(&QTableCheckpointer::run, this);
+}
+
+QTableCheckpointer::~QTableCheckpointer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (unsaved && !pending) pending = std::move(unsaved); // One last try
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    if (unsaved) {
+        int rows = 0;
+        for (int i = 0; i < QTable::STATES; ++i) rows += unsaved->isDirty(i) ? 1 : 0;
+        std::cerr << "Checkpoint of " << rows << " states could not be written to " << store.getFilename() << std::endl;
+    }
+}
+
+void QTableCheckpointer::submit(QTable& table) {
+    // Copy outside the lock; the trainer only ever waits for a pointer swap
+    auto snapshot = std::make_unique<QTable>(table);
+    table.clearDirty();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const QTable* older : {pending.get(), unsaved.get()}) {
+            if (!older) continue;
+            for (int i = 0; i < QTable::STATES; ++i) {
+                if (older->isDirty(i)) snapshot->markDirty(i);
+            }
+        }
+        unsaved.reset();
+        pending = std::move(snapshot);
+    }
+    wake.notify_one();
+}
+
+bool QTableCheckpointer::flush(QTable& table) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto done = [this]() { return !pending && !busy; };
+    idle.wait(lock, done);
+    if (unsaved) {
+        pending = std::move(unsaved);
+        wake.notify_one();
+        idle.wait(lock, done);
+    }
+    if (!unsaved) return true;
+
+    // submit() cleared these flags in the caller's table; hand the rows back
+    for (int i = 0; i < QTable::STATES; ++i) {
+        if (unsaved->isDirty(i)) table.markDirty(i);
+    }
+    unsaved.reset();
+    return false;
+}
+
+int QTableCheckpointer::checkpointsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+int QTableCheckpointer::failures() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+void QTableCheckpointer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this]() { return pending || stopping; });
+        if (!pending) break; // Stopping with nothing left to write
+
+        std::unique_ptr<QTable> snapshot = std::move(pending);
+        busy = true;
+        bool replace = replacing;
+        lock.unlock();
+        // Snapshots are whole copies of the table, so one can stand in for the file's contents
+        bool ok = replace ? store.replace(*snapshot) : store.saveDirty(*snapshot);
+        lock.lock();
+        busy = false;
+        if (ok) {
+            ++written;
+            replacing = false;
+        } else {
+            // Keep the rows so the next snapshot retries them
+            ++failed;
+            unsaved = std::move(snapshot);
+        }
+        idle.notify_all();
+    }
+    idle.notify_all();
+}
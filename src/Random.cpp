@@ -0,0 +1,55 @@
+#include <atomic>
+#include <mutex>
+#include <random>
+#include "Random.h"
+
+namespace {
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+std::mutex seedMutex;
+bool seedSet = false;
+uint64_t masterSeed = 0;
+
+// Streams for threadRng() start well above the fixed ids in RngStreamId
+std::atomic<uint64_t> nextThreadStream{1ULL << 32};
+
+} // namespace
+
+void Rng::seedWith(uint64_t seed) {
+    // SplitMix64 expands the seed so that similar seeds give unrelated states
+    uint64_t x = seed;
+    for (auto& word : s) word = splitmix64(x);
+}
+
+uint64_t getMasterSeed() {
+    std::lock_guard<std::mutex> lock(seedMutex);
+    if (!seedSet) {
+        std::random_device device;
+        masterSeed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        seedSet = true;
+    }
+    return masterSeed;
+}
+
+void setMasterSeed(uint64_t seed) {
+    std::lock_guard<std::mutex> lock(seedMutex);
+    masterSeed = seed;
+    seedSet = true;
+}
+
+Rng streamRng(uint64_t streamId) {
+    // Hash (seed, stream) to a fresh seed; SplitMix64 then fills the state
+    uint64_t x = getMasterSeed() ^ (0xD1B54A32D192ED03ULL * (streamId + 1));
+    return Rng(splitmix64(x));
+}
+
+Rng& threadRng() {
+    thread_local Rng rng = streamRng(nextThreadStream++);
+    return rng;
+}
@@ -1,12 +1,17 @@
 #include "Renderer.h"
 #include "Card.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <filesystem>
 
-Renderer::Renderer() {
+Renderer::Renderer(int frameBudgetMs, bool offscreen)
+    : frameBudgetMs(frameBudgetMs), offscreen(offscreen), lastFrame(std::chrono::steady_clock::now()) {
     // Create a green blackjack table
     table = cv::Mat(TABLE_HEIGHT, TABLE_WIDTH, CV_8UC3, cv::Scalar(0, 100, 0));
     loadAssets();
+    composeBackgrounds();
 }
 
 Renderer::~Renderer() {
@@ -19,7 +24,7 @@ std::string Renderer::getCardFilename(const Card& card) {
     std::string suitStr;
 
     // Map rank to string
-    switch (card.rank) {
+    switch (card.getRank()) {
         case Rank::ACE: rankStr = "ace"; break;
         case Rank::TWO: rankStr = "2"; break;
         case Rank::THREE: rankStr = "3"; break;
@@ -36,7 +41,7 @@ std::string Renderer::getCardFilename(const Card& card) {
     }
 
     // Map suit to string
-    switch (card.suit) {
+    switch (card.getSuit()) {
         case Suit::SPADES: suitStr = "spades"; break;
         case Suit::HEARTS: suitStr = "hearts"; break;
         case Suit::DIAMONDS: suitStr = "diamonds"; break;
@@ -46,74 +51,154 @@ std::string Renderer::getCardFilename(const Card& card) {
     return "assets/cards/" + rankStr + "_of_" + suitStr + ".png";
 }
 
+std::string Renderer::spriteFilename(int slot) {
+    return slot == CARD_BACK ? "assets/cards/red_joker.png" : getCardFilename(Card::fromId(slot));
+}
+
+namespace {
+
+const char* ATLAS_CACHE = "assets/card_atlas.cache";
+constexpr char ATLAS_MAGIC[8] = {'B', 'J', 'A', 'T', 'L', 'A', 'S', '1'};
+
+struct AtlasCacheHeader {
+    char magic[8];
+    uint64_t key;
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    int32_t sprites;
+};
+
+void fnv1a(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+} // namespace
+
+uint64_t Renderer::assetKey() {
+    // Size and modification time of every source PNG, plus the card size
+    uint64_t key = 0xcbf29ce484222325ULL;
+    int size[2] = {CARD_WIDTH, CARD_HEIGHT};
+    fnv1a(key, size, sizeof(size));
+    for (int slot = 0; slot < SPRITES; ++slot) {
+        std::string filename = spriteFilename(slot);
+        std::error_code error;
+        int64_t stamp[2] = {-1, -1};
+        auto bytes = std::filesystem::file_size(filename, error);
+        if (!error) {
+            stamp[0] = static_cast<int64_t>(bytes);
+            stamp[1] = std::filesystem::last_write_time(filename, error).time_since_epoch().count();
+        }
+        fnv1a(key, filename.data(), filename.size());
+        fnv1a(key, stamp, sizeof(stamp));
+    }
+    return key;
+}
+
+bool Renderer::loadAtlasCache(uint64_t key) {
+    std::ifstream in(ATLAS_CACHE, std::ios::binary);
+    AtlasCacheHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0 || header.key != key ||
+        header.rows != atlas.rows || header.cols != atlas.cols || header.type != atlas.type() ||
+        header.sprites != SPRITES) {
+        return false; // Stale: a PNG or the card size changed since it was written
+    }
+    in.read(reinterpret_cast<char*>(hasSprite.data()), sizeof(bool) * SPRITES);
+    in.read(reinterpret_cast<char*>(atlas.data), static_cast<std::streamsize>(atlas.total() * atlas.elemSize()));
+    return static_cast<bool>(in);
+}
+
+void Renderer::saveAtlasCache(uint64_t key) {
+    AtlasCacheHeader header{};
+    std::memcpy(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+    header.key = key;
+    header.rows = atlas.rows;
+    header.cols = atlas.cols;
+    header.type = atlas.type();
+    header.sprites = SPRITES;
+
+    // Write then rename, so a second instance starting up never reads half a file
+    std::string temp = std::string(ATLAS_CACHE) + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(hasSprite.data()), sizeof(bool) * SPRITES);
+        out.write(reinterpret_cast<const char*>(atlas.data), static_cast<std::streamsize>(atlas.total() * atlas.elemSize()));
+        if (!out) {
+            std::cerr << "Warning: Could not write " << temp << "; the next launch decodes the PNGs again" << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, ATLAS_CACHE, error);
+    if (error) std::cerr << "Warning: Could not write " << ATLAS_CACHE << ": " << error.message() << std::endl;
+}
+
+void Renderer::decodeAtlas() {
+    // Each slot decodes and resizes into its own region of the atlas, so slots run in parallel
+    cv::parallel_for_(cv::Range(0, SPRITES), [this](const cv::Range& range) {
+        for (int slot = range.start; slot < range.end; ++slot) {
+            cv::Mat img = cv::imread(spriteFilename(slot));
+            hasSprite[slot] = !img.empty();
+            if (hasSprite[slot]) cv::resize(img, sprites[slot], cv::Size(CARD_WIDTH, CARD_HEIGHT), 0, 0, cv::INTER_AREA);
+        }
+    });
+}
+
 void Renderer::loadAssets() {
-    // Load all card images and resize them for display
-    Rank ranks[] = {Rank::ACE, Rank::TWO, Rank::THREE, Rank::FOUR, Rank::FIVE,
-                    Rank::SIX, Rank::SEVEN, Rank::EIGHT, Rank::NINE, Rank::TEN,
-                    Rank::JACK, Rank::QUEEN, Rank::KING};
-    Suit suits[] = {Suit::SPADES, Suit::HEARTS, Suit::DIAMONDS, Suit::CLUBS};
-
-    for (Rank rank : ranks) {
-        for (Suit suit : suits) {
-            Card card(rank, suit);
-            std::string filename = getCardFilename(card);
-            
-            cv::Mat img = cv::imread(filename);
-            if (img.empty()) {
-                std::cerr << "Warning: Could not load " << filename << std::endl;
-                continue;
-            }
-
-            // Resize to standard card size for display
-            cv::resize(img, img, cv::Size(CARD_WIDTH, CARD_HEIGHT));
-            cardCache[filename] = img;
+    auto start = std::chrono::steady_clock::now();
+
+    int atlasRows = SPRITES / ATLAS_COLUMNS + 1;
+    atlas = cv::Mat(atlasRows * CARD_HEIGHT, ATLAS_COLUMNS * CARD_WIDTH, CV_8UC3, cv::Scalar(0, 0, 0));
+    for (int slot = 0; slot < SPRITES; ++slot) {
+        sprites[slot] = atlas(cv::Rect((slot % ATLAS_COLUMNS) * CARD_WIDTH, (slot / ATLAS_COLUMNS) * CARD_HEIGHT,
+                                       CARD_WIDTH, CARD_HEIGHT));
+    }
+
+    uint64_t key = assetKey();
+    bool cached = loadAtlasCache(key);
+    if (!cached) {
+        decodeAtlas();
+        for (int slot = 0; slot < SPRITES; ++slot) {
+            if (!hasSprite[slot]) std::cerr << "Warning: Could not load " << spriteFilename(slot) << std::endl;
         }
+        saveAtlasCache(key);
     }
 
-    std::cout << "Loaded " << cardCache.size() << " card images." << std::endl;
+    int loaded = static_cast<int>(std::count(hasSprite.begin(), hasSprite.begin() + CARD_BACK, true));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Loaded " << loaded << " card images " << (cached ? "from the atlas cache" : "from PNGs")
+              << " in " << elapsed.count() << " ms." << std::endl;
 }
 
 void Renderer::drawCard(int x, int y, const Card& card, bool hidden) {
-    if (hidden) {
-        // Draw the back of a card using red_joker.png
-        cv::Mat cardBack = cv::imread("assets/cards/red_joker.png");
-        if (cardBack.empty()) {
-            // Fallback to blue rectangle if image not found
-            cv::rectangle(table, cv::Point(x, y), 
-                         cv::Point(x + CARD_WIDTH, y + CARD_HEIGHT), 
-                         cv::Scalar(200, 100, 0), -1);
-            cv::rectangle(table, cv::Point(x, y), 
-                         cv::Point(x + CARD_WIDTH, y + CARD_HEIGHT), 
-                         cv::Scalar(255, 200, 0), 2);
-            cv::putText(table, "?", cv::Point(x + CARD_WIDTH/2 - 10, y + CARD_HEIGHT/2 + 10),
-                       cv::FONT_HERSHEY_SIMPLEX, 1.5, cv::Scalar(255, 255, 255), 2);
-        } else {
-            // Resize to card size and draw
-            cv::resize(cardBack, cardBack, cv::Size(CARD_WIDTH, CARD_HEIGHT));
-            cv::Mat roi = table(cv::Rect(x, y, CARD_WIDTH, CARD_HEIGHT));
-            cardBack.copyTo(roi);
-            
-            // Draw border around the card
-            cv::rectangle(table, cv::Point(x, y), 
-                         cv::Point(x + CARD_WIDTH, y + CARD_HEIGHT), 
-                         cv::Scalar(255, 255, 255), 2);
-        }
-        return;
+    if (x + CARD_WIDTH >= TABLE_WIDTH || y + CARD_HEIGHT >= TABLE_HEIGHT) {
+        return; // Hand wider than the table; the totals still show it
     }
 
-    std::string filename = getCardFilename(card);
-    
-    // Check if card is in cache
-    if (cardCache.find(filename) == cardCache.end()) {
-        std::cerr << "Card not in cache: " << filename << std::endl;
+    int slot = hidden ? CARD_BACK : card.getId();
+    if (!hasSprite[slot]) {
+        if (!hidden) return; // Already reported when the atlas was built
+        // Fallback to blue rectangle if image not found
+        cv::rectangle(table, cv::Point(x, y), 
+                     cv::Point(x + CARD_WIDTH, y + CARD_HEIGHT), 
+                     cv::Scalar(200, 100, 0), -1);
+        cv::rectangle(table, cv::Point(x, y), 
+                     cv::Point(x + CARD_WIDTH, y + CARD_HEIGHT), 
+                     cv::Scalar(255, 200, 0), 2);
+        cv::putText(table, "?", cv::Point(x + CARD_WIDTH/2 - 10, y + CARD_HEIGHT/2 + 10),
+                   cv::FONT_HERSHEY_SIMPLEX, 1.5, cv::Scalar(255, 255, 255), 2);
         return;
     }
 
-    cv::Mat cardImg = cardCache[filename];
-
     // Draw the card image onto the table
     cv::Mat roi = table(cv::Rect(x, y, CARD_WIDTH, CARD_HEIGHT));
-    cardImg.copyTo(roi);
+    sprites[slot].copyTo(roi);
 
     // Draw a border around the card
     cv::rectangle(table, cv::Point(x, y), 
@@ -121,22 +206,101 @@ void Renderer::drawCard(int x, int y, const Card& card, bool hidden) {
                  cv::Scalar(255, 255, 255), 2);
 }
 
-void Renderer::displayState(const Hand& player, const Hand& dealer, std::string message, bool dealersTurn) {
-    // 1. Refresh table to green
-    table = cv::Mat(TABLE_HEIGHT, TABLE_WIDTH, CV_8UC3, cv::Scalar(0, 100, 0));
+void Renderer::composeBackgrounds() {
+    stateBackground = cv::Mat(TABLE_HEIGHT, TABLE_WIDTH, CV_8UC3, cv::Scalar(0, 100, 0));
+    cv::putText(stateBackground, "DEALER", cv::Point(20, 30), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
+    actionBackground = stateBackground.clone();
 
-    // 2. Draw Dealer Section (Top)
-    cv::putText(table, "DEALER", cv::Point(20, 30), 
+    cv::putText(stateBackground, "PLAYER", cv::Point(20, TABLE_HEIGHT - 180), 
                cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
-    
+    cv::putText(actionBackground, "PLAYER", cv::Point(20, TABLE_HEIGHT - 220), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
+
+    // The HIT/STAND buttons never change, so they live in the action background
+    int fontFace = cv::FONT_HERSHEY_SIMPLEX;
+    int thickness = 2;
+    struct Button { std::string text; int centerY; cv::Scalar fill; };
+    for (const Button& button : {Button{"Press H to HIT", TABLE_HEIGHT / 2 + 20, cv::Scalar(0, 100, 200)},
+                                 Button{"Press S to STAND", TABLE_HEIGHT / 2 + 70, cv::Scalar(150, 0, 150)}}) {
+        cv::Size size = cv::getTextSize(button.text, fontFace, 0.8, thickness, nullptr);
+        int centerX = (TABLE_WIDTH - size.width) / 2;
+        cv::rectangle(actionBackground, cv::Point(centerX - 15, button.centerY - 25),
+                     cv::Point(centerX + size.width + 15, button.centerY + 10),
+                     button.fill, -1);
+        cv::rectangle(actionBackground, cv::Point(centerX - 15, button.centerY - 25),
+                     cv::Point(centerX + size.width + 15, button.centerY + 10),
+                     cv::Scalar(255, 255, 255), 2);
+        cv::putText(actionBackground, button.text, cv::Point(centerX, button.centerY),
+                   fontFace, 0.8, cv::Scalar(255, 255, 255), thickness);
+    }
+}
+
+const cv::Mat& Renderer::background() const {
+    return drawnLayout == Layout::Action ? actionBackground : stateBackground;
+}
+
+// Switching screens (or darkening the frame for a prompt) invalidates everything drawn
+void Renderer::beginFrame(Layout layout) {
+    if (layout == drawnLayout) return;
+    drawnLayout = layout;
+    background().copyTo(table);
+    for (DrawnHand* drawn : {&drawnDealer, &drawnPlayer}) {
+        drawn->slots.fill(EMPTY_SLOT);
+        drawn->total.clear();
+    }
+    drawnMessage.clear();
+}
+
+void Renderer::restore(const cv::Rect& region) {
+    cv::Rect clipped = region & cv::Rect(0, 0, TABLE_WIDTH, TABLE_HEIGHT);
+    if (clipped.area() > 0) background()(clipped).copyTo(table(clipped));
+}
+
+void Renderer::updateHand(DrawnHand& drawn, const Hand& hand, int x, int y, int hiddenIndex) {
+    for (int i = 0; i < Hand::MAX_CARDS; ++i) {
+        int wanted = EMPTY_SLOT;
+        if (i < hand.getSize()) wanted = (i == hiddenIndex) ? HIDDEN_SLOT : hand.getCard(i).getId();
+        if (wanted == drawn.slots[i]) continue;
+
+        // The border is 2px wide centred on the card edge, so clear one pixel around the card
+        int cardX = x + i * (CARD_WIDTH + 10);
+        restore(cv::Rect(cardX - 1, y - 1, CARD_WIDTH + 3, CARD_HEIGHT + 3));
+        if (wanted != EMPTY_SLOT) drawCard(cardX, y, hand.getCard(i), wanted == HIDDEN_SLOT);
+        drawn.slots[i] = wanted;
+    }
+}
+
+void Renderer::updateText(std::string& drawn, const std::string& text, const cv::Rect& strip, cv::Point origin,
+                          double scale, const cv::Scalar& color) {
+    if (text == drawn) return;
+    restore(strip);
+    cv::putText(table, text, origin, cv::FONT_HERSHEY_SIMPLEX, scale, color, 2);
+    drawn = text;
+}
+
+int Renderer::showFrame(bool waitForKey) {
+    if (offscreen) return -1; // The caller reads the frame with getFrame()
+    cv::imshow("Blackjack AI", table);
+    int key;
+    if (waitForKey) {
+        key = cv::waitKey(0); // Wait indefinitely for key press
+    } else {
+        // Hold the frame for whatever is left of its budget; waitKey(0) would block, so wait at least 1ms
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastFrame);
+        key = cv::waitKey(std::max(1, frameBudgetMs - static_cast<int>(elapsed.count())));
+    }
+    lastFrame = std::chrono::steady_clock::now();
+    return key;
+}
+
+void Renderer::displayState(const Hand& player, const Hand& dealer, std::string message, bool dealersTurn) {
+    beginFrame(Layout::State);
+
+    // Dealer Section (Top): hide the second card until the dealer's turn
     int dealerX = 50;
     int dealerY = 60;
-    
-    // Draw dealer cards
-    for (int i = 0; i < dealer.getSize(); i++) {
-        bool isHidden = (i == 1 && !dealersTurn); // Hide second card only if not dealer's turn
-        drawCard(dealerX + (i * (CARD_WIDTH + 10)), dealerY, dealer.getCard(i), isHidden);
-    }
+    updateHand(drawnDealer, dealer, dealerX, dealerY, dealersTurn ? -1 : 1);
 
     // Dealer total - only show visible cards total
     int dealerVisibleTotal = dealer.getTotal();
@@ -144,53 +308,32 @@ void Renderer::displayState(const Hand& player, const Hand& dealer, std::string
         // Subtract the hidden card's value from the total
         dealerVisibleTotal -= dealer.getCard(1).getValue();
     }
-    
-    std::string dealerTotal = "Total: " + std::to_string(dealerVisibleTotal);
-    cv::putText(table, dealerTotal, cv::Point(dealerX, dealerY + CARD_HEIGHT + 40),
-               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
-
-    // 3. Draw Player Section (Bottom)
-    cv::putText(table, "PLAYER", cv::Point(20, TABLE_HEIGHT - 180), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
+    cv::Point dealerTotalAt(dealerX, dealerY + CARD_HEIGHT + 40);
+    updateText(drawnDealer.total, "Total: " + std::to_string(dealerVisibleTotal),
+               cv::Rect(0, dealerTotalAt.y - 22, TABLE_WIDTH, 30), dealerTotalAt, 0.7, cv::Scalar(255, 255, 255));
 
+    // Player Section (Bottom)
     int playerX = 50;
     int playerY = TABLE_HEIGHT - 150;
+    updateHand(drawnPlayer, player, playerX, playerY, -1);
 
-    // Draw player cards
-    for (int i = 0; i < player.getSize(); i++) {
-        drawCard(playerX + (i * (CARD_WIDTH + 10)), playerY, player.getCard(i), false);
-    }
+    cv::Point playerTotalAt(playerX, playerY + CARD_HEIGHT + 40);
+    updateText(drawnPlayer.total, "Total: " + std::to_string(player.getTotal()),
+               cv::Rect(0, playerTotalAt.y - 22, TABLE_WIDTH, 30), playerTotalAt, 0.7, cv::Scalar(255, 255, 255));
 
-    // Player total
-    std::string playerTotal = "Total: " + std::to_string(player.getTotal());
-    cv::putText(table, playerTotal, cv::Point(playerX, playerY + CARD_HEIGHT + 40),
-               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
+    // Message in center
+    cv::Size textSize = cv::getTextSize(message, cv::FONT_HERSHEY_SIMPLEX, 1.0, 2, nullptr);
+    cv::Point messageAt((TABLE_WIDTH - textSize.width) / 2, TABLE_HEIGHT / 2);
+    updateText(drawnMessage, message, cv::Rect(0, messageAt.y - 30, TABLE_WIDTH, 42), messageAt, 1.0,
+               cv::Scalar(255, 255, 0));
 
-    // 4. Display message in center
-    int fontFace = cv::FONT_HERSHEY_SIMPLEX;
-    double fontScale = 1.0;
-    int thickness = 2;
-    cv::Size textSize = cv::getTextSize(message, fontFace, fontScale, thickness, nullptr);
-    
-    int centerX = (TABLE_WIDTH - textSize.width) / 2;
-    int centerY = TABLE_HEIGHT / 2;
-
-    cv::putText(table, message, cv::Point(centerX, centerY),
-               fontFace, fontScale, cv::Scalar(255, 255, 0), thickness);
-
-    // 5. Show window
-    cv::imshow("Blackjack AI", table);
-    cv::waitKey(500); // 500ms delay for visualization
+    showFrame(false);
 }
 
 void Renderer::displayPrompt(const Hand& player, const Hand& dealer, const std::string& prompt, const std::string& result) {
-    // Don't refresh the table - keep the current game state visible
-    
-    // Draw a semi-transparent overlay
-    cv::Mat overlay = table.clone();
-    cv::rectangle(overlay, cv::Point(0, 0), cv::Point(TABLE_WIDTH, TABLE_HEIGHT),
-                 cv::Scalar(0, 0, 0), -1);
-    cv::addWeighted(overlay, 0.3, table, 0.7, 0, table);
+    // Keep the current game state visible, dimmed to 70% (same as blending in 30% black)
+    table.convertTo(table, -1, 0.7, 0);
+    drawnLayout = Layout::None; // The frame no longer matches either background
 
     // Display result above the prompt
     int fontFace = cv::FONT_HERSHEY_SIMPLEX;
@@ -224,98 +367,50 @@ void Renderer::displayPrompt(const Hand& player, const Hand& dealer, const std::
     cv::putText(table, prompt, cv::Point(centerX, centerY + 10),
                fontFace, promptScale, cv::Scalar(255, 255, 0), thickness);
 
-    // Show window and wait for key press
-    cv::imshow("Blackjack AI", table);
-    lastKeyPressed = cv::waitKey(0); // Wait indefinitely for key press
+    if (!autoAdvance) {
+        lastKeyPressed = showFrame(true);
+        return;
+    }
+    // Unattended playback: no key within the frame budget means "play on"
+    int key = showFrame(false);
+    bool stop = key == 'n' || key == 'N' || key == 'q' || key == 'Q' || key == 27;
+    lastKeyPressed = stop ? 'n' : 'y';
 }
 
 int Renderer::displayActionPrompt(const Hand& player, const Hand& dealer, const std::string& message) {
-    // 1. Refresh table to green
-    table = cv::Mat(TABLE_HEIGHT, TABLE_WIDTH, CV_8UC3, cv::Scalar(0, 100, 0));
+    beginFrame(Layout::Action);
 
-    // 2. Draw Dealer Section (Top)
-    cv::putText(table, "DEALER", cv::Point(20, 30), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
-    
+    // Dealer Section (Top), second card hidden
     int dealerX = 50;
     int dealerY = 60;
-    
-    // Draw dealer cards
-    for (int i = 0; i < dealer.getSize(); i++) {
-        bool isHidden = (i == 1); // Hide second card
-        drawCard(dealerX + (i * (CARD_WIDTH + 10)), dealerY, dealer.getCard(i), isHidden);
-    }
+    updateHand(drawnDealer, dealer, dealerX, dealerY, 1);
 
     // Dealer total - only show visible cards total
     int dealerVisibleTotal = dealer.getTotal();
     if (dealer.getSize() > 1) {
         dealerVisibleTotal -= dealer.getCard(1).getValue();
     }
-    
-    std::string dealerTotal = "Total: " + std::to_string(dealerVisibleTotal);
-    cv::putText(table, dealerTotal, cv::Point(dealerX, dealerY + CARD_HEIGHT + 40),
-               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
-
-    // 3. Draw Player Section (Bottom)
-    cv::putText(table, "PLAYER", cv::Point(20, TABLE_HEIGHT - 220), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
+    cv::Point dealerTotalAt(dealerX, dealerY + CARD_HEIGHT + 40);
+    updateText(drawnDealer.total, "Total: " + std::to_string(dealerVisibleTotal),
+               cv::Rect(0, dealerTotalAt.y - 22, TABLE_WIDTH, 30), dealerTotalAt, 0.7, cv::Scalar(255, 255, 255));
 
+    // Player Section (Bottom)
     int playerX = 50;
     int playerY = TABLE_HEIGHT - 190;
+    updateHand(drawnPlayer, player, playerX, playerY, -1);
 
-    // Draw player cards
-    for (int i = 0; i < player.getSize(); i++) {
-        drawCard(playerX + (i * (CARD_WIDTH + 10)), playerY, player.getCard(i), false);
-    }
+    cv::Point playerTotalAt(playerX, playerY + CARD_HEIGHT + 40);
+    updateText(drawnPlayer.total, "Total: " + std::to_string(player.getTotal()),
+               cv::Rect(0, playerTotalAt.y - 22, TABLE_WIDTH, 30), playerTotalAt, 0.7, cv::Scalar(255, 255, 255));
 
-    // Player total
-    std::string playerTotal = "Total: " + std::to_string(player.getTotal());
-    cv::putText(table, playerTotal, cv::Point(playerX, playerY + CARD_HEIGHT + 40),
-               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
+    // Main message; the HIT/STAND options are part of the background
+    cv::Size msgSize = cv::getTextSize(message, cv::FONT_HERSHEY_SIMPLEX, 1.0, 2, nullptr);
+    cv::Point messageAt((TABLE_WIDTH - msgSize.width) / 2, TABLE_HEIGHT / 2 - 40);
+    updateText(drawnMessage, message, cv::Rect(0, messageAt.y - 30, TABLE_WIDTH, 42), messageAt, 1.0,
+               cv::Scalar(255, 255, 0));
 
-    // 4. Display action prompt in center with two options
-    int fontFace = cv::FONT_HERSHEY_SIMPLEX;
-    double fontScale = 1.0;
-    int thickness = 2;
-    
-    // Main message
-    cv::Size msgSize = cv::getTextSize(message, fontFace, fontScale, thickness, nullptr);
-    int msgCenterX = (TABLE_WIDTH - msgSize.width) / 2;
-    int msgCenterY = TABLE_HEIGHT / 2 - 40;
-    cv::putText(table, message, cv::Point(msgCenterX, msgCenterY),
-               fontFace, fontScale, cv::Scalar(255, 255, 0), thickness);
-
-    // Hit option
-    std::string hitText = "Press H to HIT";
-    cv::Size hitSize = cv::getTextSize(hitText, fontFace, 0.8, thickness, nullptr);
-    int hitCenterX = (TABLE_WIDTH - hitSize.width) / 2;
-    int hitCenterY = TABLE_HEIGHT / 2 + 20;
-    cv::rectangle(table, cv::Point(hitCenterX - 15, hitCenterY - 25),
-                 cv::Point(hitCenterX + hitSize.width + 15, hitCenterY + 10),
-                 cv::Scalar(0, 100, 200), -1);
-    cv::rectangle(table, cv::Point(hitCenterX - 15, hitCenterY - 25),
-                 cv::Point(hitCenterX + hitSize.width + 15, hitCenterY + 10),
-                 cv::Scalar(255, 255, 255), 2);
-    cv::putText(table, hitText, cv::Point(hitCenterX, hitCenterY),
-               fontFace, 0.8, cv::Scalar(255, 255, 255), thickness);
-
-    // Stand option
-    std::string standText = "Press S to STAND";
-    cv::Size standSize = cv::getTextSize(standText, fontFace, 0.8, thickness, nullptr);
-    int standCenterX = (TABLE_WIDTH - standSize.width) / 2;
-    int standCenterY = TABLE_HEIGHT / 2 + 70;
-    cv::rectangle(table, cv::Point(standCenterX - 15, standCenterY - 25),
-                 cv::Point(standCenterX + standSize.width + 15, standCenterY + 10),
-                 cv::Scalar(150, 0, 150), -1);
-    cv::rectangle(table, cv::Point(standCenterX - 15, standCenterY - 25),
-                 cv::Point(standCenterX + standSize.width + 15, standCenterY + 10),
-                 cv::Scalar(255, 255, 255), 2);
-    cv::putText(table, standText, cv::Point(standCenterX, standCenterY),
-               fontFace, 0.8, cv::Scalar(255, 255, 255), thickness);
-
-    // 5. Show window and wait for key press
-    cv::imshow("Blackjack AI", table);
-    int key = cv::waitKey(0);
+    // Show window and wait for key press
+    int key = showFrame(true);
     
     // Return 1 for HIT (h), 0 for STAND (s)
     if (key == 'h' || key == 'H') {
@@ -324,4 +419,4 @@ int Renderer::displayActionPrompt(const Hand& player, const Hand& dealer, const
         return 0;  // STAND
     }
     return 0;  // Default to STAND
-}
\ No newline at end of file
+}
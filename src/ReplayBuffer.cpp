@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cmath>
+#include "HandHistory.h"
+#include "ReplayBuffer.h"
+
+namespace {
+
+constexpr double MIN_PRIORITY = 1e-3; // Keeps transitions with a zero TD error reachable
+
+} // namespace
+
+ReplayBuffer::ReplayBuffer(size_t capacity, ReplaySampling sampling, Rng rng)
+    : transitions(std::max<size_t>(1, capacity)), sampling(sampling), rng(rng) {
+    if (sampling == ReplaySampling::Prioritized) {
+        leaves = 1;
+        while (leaves < transitions.size()) leaves *= 2;
+        tree.assign(2 * leaves, 0.0);
+    }
+}
+
+void ReplayBuffer::add(const Transition& transition) {
+    transitions[next] = transition;
+    if (sampling == ReplaySampling::Prioritized) setPriority(next, maxPriority);
+    next = (next + 1) % transitions.size();
+    count = std::min(count + 1, transitions.size());
+}
+
+void ReplayBuffer::sample(size_t batchSize, ReplayBatch& batch) {
+    batch.slots.resize(batchSize);
+    batch.transitions.resize(batchSize);
+    batch.tdErrors.resize(batchSize);
+    if (count == 0) {
+        batch.slots.clear();
+        batch.transitions.clear();
+        batch.tdErrors.clear();
+        batch.weights.clear();
+        return;
+    }
+
+    if (sampling == ReplaySampling::Uniform) {
+        for (auto& slot : batch.slots) slot = rng.below(static_cast<uint32_t>(count));
+        std::sort(batch.slots.begin(), batch.slots.end());
+        batch.weights.clear();
+    } else {
+        // Stratified: one draw from each equal slice of the total priority, which
+        // also leaves the slots in ascending order
+        double total = tree[1];
+        double slice = total / batchSize;
+        batch.weights.resize(batchSize);
+        double maxWeight = 0;
+        for (size_t i = 0; i < batchSize; ++i) {
+            size_t slot = findPrefix((i + rng.uniform()) * slice);
+            batch.slots[i] = static_cast<uint32_t>(slot);
+            double probability = tree[leaves + slot] / total;
+            batch.weights[i] = static_cast<float>(std::pow(count * probability, -importanceExponent));
+            maxWeight = std::max(maxWeight, static_cast<double>(batch.weights[i]));
+        }
+        // Normalized so weights only ever shrink a step
+        for (auto& w : batch.weights) w = static_cast<float>(w / maxWeight);
+    }
+
+    for (size_t i = 0; i < batchSize; ++i) batch.transitions[i] = transitions[batch.slots[i]];
+}
+
+void ReplayBuffer::updatePriorities(const ReplayBatch& batch) {
+    if (sampling != ReplaySampling::Prioritized) return;
+    for (size_t i = 0; i < batch.slots.size(); ++i) {
+        double priority = std::pow(std::abs(batch.tdErrors[i]) + MIN_PRIORITY, priorityExponent);
+        maxPriority = std::max(maxPriority, priority);
+        setPriority(batch.slots[i], priority);
+    }
+}
+
+void ReplayBuffer::setPriority(size_t slot, double priority) {
+    size_t i = leaves + slot;
+    tree[i] = priority;
+    // Parents are recomputed from their children rather than adjusted, so rounding never accumulates
+    for (i /= 2; i >= 1; i /= 2) tree[i] = tree[2 * i] + tree[2 * i + 1];
+}
+
+size_t ReplayBuffer::findPrefix(double mass) const {
+    size_t i = 1;
+    while (i < leaves) {
+        size_t left = 2 * i;
+        if (mass < tree[left]) {
+            i = left;
+        } else {
+            mass -= tree[left];
+            i = left + 1;
+        }
+    }
+    // Rounding can walk off the filled part by one leaf
+    return std::min(i - leaves, count - 1);
+}
+
+void replayBatch(QLearner& ai, ReplayBuffer& buffer, ReplayBatch& batch, size_t batchSize, double rate) {
+    buffer.sample(batchSize, batch);
+    if (batch.transitions.empty()) return;
+    ai.updateBatch(batch.transitions.data(), static_cast<int>(batch.transitions.size()), rate,
+                   batch.weights.empty() ? nullptr : batch.weights.data(), batch.tdErrors.data());
+    buffer.updatePriorities(batch);
+}
+
+HistoryReplayStats learnFromHistory(QLearner& ai, HandHistoryReader& reader, ReplayBuffer* buffer,
+                                    size_t batchSize, int batchesPerHand, double replayRate) {
+    HistoryReplayStats stats;
+    ReplayBatch batch;
+    HandRecord hand;
+    while (reader.next(hand)) {
+        ++stats.hands;
+        if (hand.settledAtDeal()) continue; // A natural, or the dealer's under peek, ends the hand before any decision
+
+        auto learn = [&](const State& s, int action, double reward, const State& nextS, bool isDone) {
+            ai.update(s, action, reward, nextS, isDone);
+            if (buffer) buffer->add(makeTransition(s, action, reward, nextS, isDone));
+            ++stats.transitions;
+        };
+
+        // Replay the player's hand card by card: every card after the first two was a hit
+        int upcard = hand.dealer.getCard(0).getValue();
+        Hand player;
+        player.addCard(hand.player.getCard(0));
+        player.addCard(hand.player.getCard(1));
+        State current = {player.getTotal(), upcard, false};
+        for (int i = 2; i < hand.player.getSize(); ++i) {
+            player.addCard(hand.player.getCard(i));
+            State nextState = {player.getTotal(), upcard, false};
+            if (player.isBust()) {
+                learn(current, 1, -1.0, nextState, true);
+            } else {
+                learn(current, 1, 0, nextState, false);
+            }
+            current = nextState;
+        }
+        if (!player.isBust()) learn(current, 0, hand.reward(), current, true);
+
+        if (buffer) {
+            for (int b = 0; b < batchesPerHand; ++b) {
+                replayBatch(ai, *buffer, batch, batchSize, replayRate);
+                ++stats.batches;
+            }
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,119 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "RuleSet.h"
+
+namespace {
+
+const char* payoutName(BlackjackPayout payout) {
+    switch (payout) {
+    case BlackjackPayout::ThreeToTwo: return "3:2";
+    case BlackjackPayout::SixToFive: return "6:5";
+    case BlackjackPayout::EvenMoney: break;
+    }
+    return "1:1";
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Applies one `key = value` line; false if the key or value is not understood
+bool applySetting(const std::string& key, const std::string& value, RuleSet& rules) {
+    if (key == "name") {
+        rules.name = value;
+    } else if (key == "dealer") {
+        if (value != "H17" && value != "S17") return false;
+        rules.hitsSoft17 = value == "H17";
+    } else if (key == "blackjack") {
+        if (value == "3:2") rules.payout = BlackjackPayout::ThreeToTwo;
+        else if (value == "6:5") rules.payout = BlackjackPayout::SixToFive;
+        else if (value == "1:1") rules.payout = BlackjackPayout::EvenMoney;
+        else return false;
+    } else if (key == "peek") {
+        if (value != "yes" && value != "no") return false;
+        rules.dealerPeeks = value == "yes";
+    } else if (key == "decks") {
+        rules.decks = std::stoi(value);
+        if (rules.decks < 1) return false;
+    } else if (key == "penetration") {
+        rules.penetration = std::stod(value);
+        if (rules.penetration <= 0 || rules.penetration > 1) return false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::string RuleSet::describe() const {
+    std::ostringstream out;
+    out << name << ": " << (hitsSoft17 ? "H17" : "S17") << ", blackjack pays " << payoutName(payout) << ", "
+        << (dealerPeeks ? "dealer peeks" : "no peek") << ", " << decks << (decks == 1 ? " deck" : " decks");
+    return out.str();
+}
+
+bool RuleSet::preset(const std::string& name, RuleSet& out) {
+    RuleSet rules;
+    rules.name = name;
+    if (name == "classic") {
+        // The defaults
+    } else if (name == "strip") {
+        rules.payout = BlackjackPayout::ThreeToTwo;
+        rules.dealerPeeks = true;
+    } else if (name == "downtown") {
+        rules.hitsSoft17 = true;
+        rules.payout = BlackjackPayout::ThreeToTwo;
+        rules.dealerPeeks = true;
+        rules.decks = 2;
+    } else if (name == "six-five") {
+        rules.hitsSoft17 = true;
+        rules.payout = BlackjackPayout::SixToFive;
+        rules.dealerPeeks = true;
+    } else if (name == "european") {
+        rules.payout = BlackjackPayout::ThreeToTwo;
+    } else {
+        return false;
+    }
+    out = rules;
+    return true;
+}
+
+bool RuleSet::load(const std::string& path, RuleSet& out) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Could not open rules file " << path << std::endl;
+        return false;
+    }
+    RuleSet rules;
+    rules.name = path;
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        size_t equals = line.find('=');
+        std::string key = trim(line.substr(0, equals));
+        std::string value = equals == std::string::npos ? "" : trim(line.substr(equals + 1));
+        bool applied = false;
+        try {
+            applied = equals != std::string::npos && applySetting(key, value, rules);
+        } catch (const std::exception&) {
+            applied = false;
+        }
+        if (!applied) {
+            std::cerr << path << ":" << number << ": bad rule \"" << line << "\": expected name, dealer = H17|S17, "
+                      << "blackjack = 3:2|6:5|1:1, peek = yes|no, decks = N or penetration = P" << std::endl;
+            return false;
+        }
+    }
+    out = rules;
+    return true;
+}
+
+bool RuleSet::resolve(const std::string& spec, RuleSet& out) {
+    return preset(spec, out) || load(spec, out);
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "Schedule.h"
+
+double Schedule::at(double count) const {
+    switch (kind) {
+    case ScheduleKind::Linear:
+        return start + (end - start) * std::min(1.0, count / span);
+    case ScheduleKind::Exponential:
+        return end + (start - end) * std::exp2(-count / span);
+    case ScheduleKind::Visits:
+        return std::max(end, start * span / (span + count));
+    case ScheduleKind::Constant:
+        break;
+    }
+    return start;
+}
+
+std::string Schedule::describe() const {
+    std::ostringstream out;
+    switch (kind) {
+    case ScheduleKind::Constant:
+        out << start;
+        break;
+    case ScheduleKind::Linear:
+        out << "linear " << start << " -> " << end << " over " << span << " hands";
+        break;
+    case ScheduleKind::Exponential:
+        out << "exponential " << start << " -> " << end << ", half-life " << span << " hands";
+        break;
+    case ScheduleKind::Visits:
+        out << start << " * " << span << " / (" << span << " + visits), floor " << end;
+        break;
+    }
+    return out.str();
+}
+
+bool Schedule::parse(const std::string& spec, Schedule& out) {
+    std::vector<std::string> parts;
+    std::stringstream in(spec);
+    for (std::string part; std::getline(in, part, ':');) parts.push_back(part);
+
+    Schedule s;
+    try {
+        if (parts.size() == 1) {
+            s.start = s.end = std::stod(parts[0]);
+        } else if (parts.size() == 4) {
+            if (parts[0] == "linear") s.kind = ScheduleKind::Linear;
+            else if (parts[0] == "exp") s.kind = ScheduleKind::Exponential;
+            else if (parts[0] == "visits") s.kind = ScheduleKind::Visits;
+            else throw std::invalid_argument(parts[0]);
+            s.start = std::stod(parts[1]);
+            s.end = std::stod(parts[2]);
+            s.span = std::stod(parts[3]);
+        } else {
+            throw std::invalid_argument(spec);
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Bad schedule \"" << spec << "\": expected a number, linear:START:END:HANDS, "
+                  << "exp:START:END:HALF_LIFE or visits:START:END:SCALE" << std::endl;
+        return false;
+    }
+    if (s.span <= 0) {
+        std::cerr << "Bad schedule \"" << spec << "\": the last value must be positive" << std::endl;
+        return false;
+    }
+    out = s;
+    return true;
+}
@@ -0,0 +1,246 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SharedQTable.h"
+
+namespace {
+
+const char SEGMENT_MAGIC[8] = {'B', 'J', 'Q', 'S', 'H', 'M', '0', '1'};
+const uint32_t SEGMENT_VERSION = 1;
+// How long attach() waits on a creator that has not finished, or a leaver deciding whether it is last
+const std::chrono::seconds ATTACH_TIMEOUT(5);
+const std::chrono::milliseconds ATTACH_POLL(1);
+
+// Slots hold pids, so a process that exits without detaching is noticed by the others
+bool alive(int32_t pid) {
+    if (pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH)) return false;
+    // A killed process stays a zombie until its parent reaps it, and a zombie never detaches
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string line;
+    if (!std::getline(stat, line)) return true;
+    size_t name = line.rfind(')');
+    return name == std::string::npos || name + 2 >= line.size() || line[name + 2] != 'Z';
+}
+
+int32_t selfPid() {
+    return static_cast<int32_t>(getpid());
+}
+
+} // namespace
+
+SharedQTable::~SharedQTable() {
+    // A last process that never persisted hands the table back, and the next one to attach keeps it
+    if (isAttached() && detach()) {
+        segment->closed.store(0);
+        segment->closing.store(0);
+    }
+    unmap();
+}
+
+bool SharedQTable::attach(const std::string& segmentName, const std::function<void(AtomicQTable&)>& seed) {
+    if (isAttached()) {
+        std::cerr << "Already attached to shared Q-table " << name << std::endl;
+        return false;
+    }
+    name = (!segmentName.empty() && segmentName[0] == '/') ? segmentName : "/" + segmentName;
+    auto deadline = std::chrono::steady_clock::now() + ATTACH_TIMEOUT;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        creator = false;
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            creator = true;
+            if (ftruncate(fd, sizeof(SharedQTableSegment)) != 0) {
+                std::cerr << "Could not size shared Q-table " << name << ": " << std::strerror(errno) << std::endl;
+                close(fd);
+                shm_unlink(name.c_str());
+                return false;
+            }
+        } else if (errno == EEXIST) {
+            fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0) {
+                if (errno == ENOENT) continue; // The last process unlinked it in between
+                std::cerr << "Could not open shared Q-table " << name << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                // Created but not sized yet
+                close(fd);
+                std::this_thread::sleep_for(ATTACH_POLL);
+                continue;
+            }
+            if (st.st_size != static_cast<off_t>(sizeof(SharedQTableSegment))) {
+                std::cerr << "Cannot use shared Q-table " << name << ": segment is " << st.st_size << " bytes, expected "
+                          << sizeof(SharedQTableSegment) << std::endl;
+                close(fd);
+                return false;
+            }
+        } else {
+            std::cerr << "Could not create shared Q-table " << name << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        bool mapped = map(fd);
+        close(fd); // The mapping keeps the segment
+        if (!mapped) {
+            if (creator) shm_unlink(name.c_str());
+            return false;
+        }
+
+        if (creator) {
+            std::memcpy(segment->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+            segment->version = SEGMENT_VERSION;
+            segment->states = QTable::STATES;
+            segment->actions = QTable::ACTIONS;
+            segment->maxMembers = SharedQTableSegment::MAX_MEMBERS;
+            seed(*view);
+            claimSlot();
+            segment->ready.store(1, std::memory_order_release);
+            return true;
+        }
+
+        while (segment->ready.load(std::memory_order_acquire) == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(ATTACH_POLL);
+        }
+        if (segment->ready.load(std::memory_order_acquire) == 0) break;
+        const char* problem = nullptr;
+        if (std::memcmp(segment->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+            problem = "not a Q-table segment";
+        } else if (segment->version != SEGMENT_VERSION || segment->states != QTable::STATES ||
+                   segment->actions != QTable::ACTIONS ||
+                   segment->maxMembers != static_cast<uint32_t>(SharedQTableSegment::MAX_MEMBERS)) {
+            problem = "written by an incompatible build";
+        }
+        if (problem) {
+            std::cerr << "Cannot use shared Q-table " << name << ": " << problem << std::endl;
+            unmap();
+            return false;
+        }
+        if (!claimSlot()) {
+            std::cerr << "Cannot join shared Q-table " << name << ": all " << SharedQTableSegment::MAX_MEMBERS
+                      << " slots are taken" << std::endl;
+            unmap();
+            return false;
+        }
+
+        // A leaver that found no one left may be about to take the table. Our slot is
+        // visible before we read `closing`, and it reads the slots after setting it, so
+        // at least one of us sees the other.
+        bool retry = false;
+        for (;;) {
+            int32_t closer = segment->closing.load();
+            if (closer == 0) return true;
+            if (!alive(closer)) {
+                // It died deciding or persisting; the table is still here, so reopen it
+                if (segment->closing.compare_exchange_strong(closer, 0)) segment->closed.store(0);
+                continue;
+            }
+            if (segment->closed.load() != 0 || std::chrono::steady_clock::now() >= deadline) {
+                // It did not see us and is saving; join whatever segment comes next
+                segment->members[slot].store(0);
+                slot = -1;
+                unmap();
+                retry = true;
+                break;
+            }
+            std::this_thread::sleep_for(ATTACH_POLL);
+        }
+        if (retry) std::this_thread::sleep_for(ATTACH_POLL);
+    }
+    std::cerr << "Timed out joining shared Q-table " << name << " (remove /dev/shm" << name
+              << " if no process is using it)" << std::endl;
+    return false;
+}
+
+bool SharedQTable::detach() {
+    if (!isAttached()) return false;
+    segment->members[slot].store(0);
+    slot = -1;
+    reapDead();
+
+    int32_t self = selfPid();
+    for (;;) {
+        if (members() > 0) return false;
+        int32_t expected = 0;
+        if (segment->closing.compare_exchange_strong(expected, self)) break;
+        // Another leaver is deciding; it sees the same empty slots, so it will take the table
+        if (alive(expected)) return false;
+        segment->closing.compare_exchange_strong(expected, 0);
+    }
+    // Joiners publish their slot before they look at `closing`; recount now that it is set
+    if (members() > 0) {
+        segment->closing.store(0);
+        return false;
+    }
+    segment->closed.store(1);
+    return true;
+}
+
+void SharedQTable::remove() {
+    if (segment) shm_unlink(name.c_str());
+    unmap();
+}
+
+int SharedQTable::members() const {
+    if (!segment) return 0;
+    int n = 0;
+    for (const auto& member : segment->members) n += alive(member.load()) ? 1 : 0;
+    return n;
+}
+
+bool SharedQTable::leads() const {
+    if (!isAttached()) return false;
+    for (int i = 0; i < slot; ++i) {
+        if (alive(segment->members[i].load())) return false;
+    }
+    return true;
+}
+
+bool SharedQTable::map(int fd) {
+    void* mapping = mmap(nullptr, sizeof(SharedQTableSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Could not map shared Q-table " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // The segment's bytes are the objects; zero-filled pages are valid atomics
+    segment = std::launder(reinterpret_cast<SharedQTableSegment*>(mapping));
+    view.reset(new AtomicQTable(segment->table));
+    return true;
+}
+
+void SharedQTable::unmap() {
+    view.reset();
+    if (segment) munmap(segment, sizeof(SharedQTableSegment));
+    segment = nullptr;
+}
+
+bool SharedQTable::claimSlot() {
+    reapDead();
+    int32_t self = selfPid();
+    for (int i = 0; i < SharedQTableSegment::MAX_MEMBERS; ++i) {
+        int32_t expected = 0;
+        if (segment->members[i].compare_exchange_strong(expected, self)) {
+            slot = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SharedQTable::reapDead() const {
+    for (auto& member : segment->members) {
+        int32_t pid = member.load();
+        if (pid != 0 && !alive(pid)) member.compare_exchange_strong(pid, 0);
+    }
+}
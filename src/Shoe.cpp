@@ -0,0 +1,73 @@
+#include <vector>
+#include <algorithm>
+#include "Card.h"
+#include "Shoe.h"
+
+Shoe::Shoe(int numDecks, double penetration, bool lazy, Rng shoeRng)
+    : decks(std::max(1, numDecks)), lazyShuffle(lazy), rng(shoeRng) {
+    cards.reserve(decks * 52);
+    for (int d = 0; d < decks; ++d) {
+        for (int s = static_cast<int>(Suit::SPADES); s <= static_cast<int>(Suit::CLUBS); ++s) {
+            for (int r = static_cast<int>(Rank::ACE); r <= static_cast<int>(Rank::KING); ++r) {
+                cards.emplace_back(static_cast<Rank>(r), static_cast<Suit>(s));
+            }
+        }
+    }
+
+    penetration = std::clamp(penetration, 0.1, 1.0);
+    cutCard = static_cast<int>(cards.size() * penetration);
+    shuffle();
+}
+
+void Shoe::shuffle() {
+    // Dealt cards go back in simply by rewinding; a lazy shoe randomises on draw instead
+    next = 0;
+    roundStart = 0;
+    runningCount = 0;
+    if (lazyShuffle) return;
+
+    // Fisher-Yates with our own bounded draws, so a seed deals the same shoe everywhere
+    for (int i = static_cast<int>(cards.size()) - 1; i > 0; --i) {
+        std::swap(cards[i], cards[rng.below(i + 1)]);
+    }
+}
+
+Card Shoe::dealCard() {
+    if (next >= static_cast<int>(cards.size())) {
+        // A round that outran its reserve: shuffle the discards and deal on from them,
+        // keeping the cards still on the table out
+        reshuffleDiscards();
+    }
+    if (lazyShuffle) {
+        // One step of Fisher-Yates: swap a random undealt card into the deal position
+        int undealt = static_cast<int>(cards.size()) - next;
+        std::swap(cards[next], cards[next + rng.below(undealt)]);
+    }
+    runningCount += cards[next].getHiLo();
+    return cards[next++];
+}
+
+bool Shoe::prepareRound(int seats) {
+    roundStart = next;
+    if (!needsShuffle() && cardsRemaining() >= RESERVE_PER_HAND * (seats + 1)) return false;
+    shuffle();
+    return true;
+}
+
+void Shoe::reshuffleDiscards() {
+    if (roundStart == 0) {
+        // This round has dealt the whole shoe; there is nothing else to deal from
+        shuffle();
+        return;
+    }
+    // The round's cards move to the front, still dealt; the discards behind them are the new undealt part
+    std::rotate(cards.begin(), cards.begin() + roundStart, cards.end());
+    next = static_cast<int>(cards.size()) - roundStart;
+    roundStart = 0;
+    runningCount = 0;
+    for (int i = 0; i < next; ++i) runningCount += cards[i].getHiLo();
+    if (lazyShuffle) return;
+    for (int i = static_cast<int>(cards.size()) - 1; i > next; --i) {
+        std::swap(cards[i], cards[next + rng.below(i - next + 1)]);
+    }
+}
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include "TableSimulator.h"
+#include "Hand.h"
+#include "HandHistory.h"
+#include "PolicyGrader.h"
+#include "QTableStore.h"
+#include "Random.h"
+#include "RuleSet.h"
+#include "Shoe.h"
+
+namespace {
+
+// Hand-based schedules move on every this many episodes, as in the trainer
+constexpr long long SCHEDULE_STEP = 256;
+
+// A recorded seat keeps at most this many hands of its log in memory and loops over them
+constexpr size_t MAX_RECORDED_HANDS = 1 << 20;
+
+int fixedAction(const Seat& seat, const Hand& hand, int upCard) {
+    if (seat.policy) {
+        const double* q = seat.policy->at(State{hand.getTotal(), upCard, false});
+        return (q[1] > q[0]) ? 1 : 0;
+    }
+    return hand.getTotal() < seat.standOn ? 1 : 0;
+}
+
+// The player hit once for every card after the first two
+bool loadRecordedSeat(const std::string& path, Seat& seat) {
+    HandHistoryReader reader(path);
+    if (!reader.isOpen()) return false;
+    HandRecord record;
+    while (seat.hits.size() < MAX_RECORDED_HANDS && reader.next(record)) {
+        seat.hits.push_back(static_cast<uint8_t>(std::max(0, record.player.getSize() - 2)));
+    }
+    if (seat.hits.empty()) {
+        std::cerr << "No hands recorded in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename Rules>
+TableStats playTable(std::vector<Seat>& seats, long long episodes, const TrainerConfig& config) {
+    TableStats stats;
+    int n = static_cast<int>(seats.size());
+
+    // The single-threaded trainer's streams: the shoe, then one exploration stream per learner
+    Shoe shoe(config.decks, config.penetration, config.lazyShuffle, streamRng(STREAM_TRAINER));
+    std::vector<QLearner*> learners;
+    for (Seat& seat : seats) {
+        seat.hands = 0;
+        seat.reward = 0;
+        if (seat.kind != SeatKind::Learner || !seat.learner) continue;
+        if (std::find(learners.begin(), learners.end(), seat.learner) != learners.end()) continue;
+        seat.learner->rng = streamRng(STREAM_TRAINER + 2 * static_cast<int>(learners.size()) + 1);
+        learners.push_back(seat.learner);
+    }
+    if (learners.empty()) return stats;
+
+    bool checkpoints = config.checkpointer && config.checkpointInterval > 0;
+    if (config.history) config.history->beginSession(HistorySource::Training, getMasterSeed(), config.decks, config.rules);
+    HandHistoryBlock block;
+
+    Hand hands[MAX_SEATS];
+    State states[MAX_SEATS];         // Where each learner seat stood, for its final update
+    bool settled[MAX_SEATS];         // Decided by the deal: a natural, or the dealer's under peek
+    HandOutcome outcomes[MAX_SEATS];
+    double rewards[MAX_SEATS];
+    long long played = 0;
+    long long nextSchedule = 0;
+    long long nextCheckpoint = config.checkpointInterval;
+    auto start = std::chrono::steady_clock::now();
+
+    while (played < episodes) {
+        if (played >= nextSchedule) {
+            for (QLearner* learner : learners) learner->advanceSchedules(played);
+            nextSchedule = (played / SCHEDULE_STEP + 1) * SCHEDULE_STEP;
+        }
+        bool reshuffled = shoe.prepareRound(n);
+
+        // Initial deal, round the table twice
+        Hand dealer;
+        for (int s = 0; s < n; ++s) hands[s] = Hand();
+        for (int s = 0; s < n; ++s) hands[s].addCard(shoe.dealCard());
+        dealer.addCard(shoe.dealCard());
+        for (int s = 0; s < n; ++s) hands[s].addCard(shoe.dealCard());
+        dealer.addCard(shoe.dealCard());
+        int upCard = dealer.getCard(0).getValue();
+
+        // Seats' turns
+        bool anyStanding = false;
+        for (int s = 0; s < n; ++s) {
+            Seat& seat = seats[s];
+            Hand& hand = hands[s];
+            settled[s] = Rules::settleDeal(hand, dealer, outcomes[s], rewards[s]);
+            if (settled[s]) continue;
+            switch (seat.kind) {
+            case SeatKind::Learner: {
+                State current = {hand.getTotal(), upCard, false};
+                while (!hand.isBust() && seat.learner->decide(current, true) == 1) {
+                    hand.addCard(shoe.dealCard());
+                    State next = {hand.getTotal(), upCard, false};
+                    seat.learner->update(current, 1, hand.isBust() ? -1.0 : 0, next, hand.isBust());
+                    current = next;
+                }
+                states[s] = current;
+                break;
+            }
+            case SeatKind::Fixed:
+                while (!hand.isBust() && fixedAction(seat, hand, upCard) == 1) hand.addCard(shoe.dealCard());
+                break;
+            case SeatKind::Recorded: {
+                int take = seat.hits[seat.nextRecord];
+                seat.nextRecord = (seat.nextRecord + 1) % seat.hits.size();
+                for (int k = 0; k < take && !hand.isBust(); ++k) hand.addCard(shoe.dealCard());
+                break;
+            }
+            }
+            anyStanding = anyStanding || !hand.isBust();
+        }
+
+        // One dealer pass settles every seat; with no one left standing the dealer does not draw
+        if (anyStanding) {
+            while (Rules::dealerDraws(dealer)) dealer.addCard(shoe.dealCard());
+        }
+        for (int s = 0; s < n; ++s) {
+            Seat& seat = seats[s];
+            HandOutcome outcome = settled[s] ? outcomes[s] : settleHand(hands[s], dealer);
+            double reward = settled[s] ? rewards[s] : outcomeReward(outcome);
+            if (seat.kind == SeatKind::Learner) {
+                if (!settled[s] && !hands[s].isBust()) seat.learner->update(states[s], 0, reward, states[s], true);
+                ++played;
+            }
+            ++seat.hands;
+            seat.reward += reward;
+            if (config.history) block.record(hands[s], dealer, outcome, reshuffled && s == 0);
+        }
+        ++stats.rounds;
+
+        if (checkpoints && played >= nextCheckpoint) {
+            // The checkpointer keeps one table: the first learner's
+            config.checkpointer->submit(learners.front()->qTable);
+            nextCheckpoint += config.checkpointInterval;
+        }
+        if (block.size() >= HandHistoryWriter::BLOCK_BYTES) {
+            config.history->append(block);
+            block.clear();
+        }
+    }
+    if (config.history && block.size() > 0) config.history->append(block);
+
+    stats.episodes = played;
+    stats.seatHands = stats.rounds * n;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.episodesPerSecond = stats.seconds > 0 ? played / stats.seconds : 0;
+    return stats;
+}
+
+} // namespace
+
+const char* Seat::kindName() const {
+    switch (kind) {
+    case SeatKind::Learner: return "learner";
+    case SeatKind::Fixed: return policy ? "policy" : "fixed";
+    case SeatKind::Recorded: return "recorded";
+    }
+    return "?";
+}
+
+bool parseSeats(const std::string& spec, QLearner& learner, const QTable* policy, std::vector<Seat>& seats) {
+    seats.clear();
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        Seat seat;
+        std::string kind = item.substr(0, item.find(':'));
+        std::string arg = item.find(':') == std::string::npos ? "" : item.substr(item.find(':') + 1);
+        if (kind == "learner") {
+            seat.learner = &learner;
+        } else if (kind == "fixed") {
+            seat.kind = SeatKind::Fixed;
+            if (!arg.empty()) seat.standOn = std::atoi(arg.c_str());
+        } else if (kind == "policy") {
+            if (!policy || policy->empty()) {
+                std::cerr << "A \"policy\" seat needs a trained Q-table in the database" << std::endl;
+                return false;
+            }
+            seat.kind = SeatKind::Fixed;
+            seat.policy = policy;
+        } else if (kind == "recorded" && !arg.empty()) {
+            seat.kind = SeatKind::Recorded;
+            if (!loadRecordedSeat(arg, seat)) return false;
+        } else {
+            std::cerr << "Unknown seat \"" << item << "\": expected learner, fixed[:N], policy or recorded:FILE"
+                      << std::endl;
+            return false;
+        }
+        seats.push_back(std::move(seat));
+    }
+    if (seats.empty() || seats.size() > static_cast<size_t>(MAX_SEATS)) {
+        std::cerr << "A table has 1 to " << MAX_SEATS << " seats, got " << seats.size() << std::endl;
+        return false;
+    }
+    if (std::none_of(seats.begin(), seats.end(), [](const Seat& s) { return s.kind == SeatKind::Learner; })) {
+        std::cerr << "A table needs at least one learner seat to train" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+TableStats runTableTrainer(std::vector<Seat>& seats, long long episodes, const TrainerConfig& config) {
+    if (seats.empty() || seats.size() > static_cast<size_t>(MAX_SEATS)) return TableStats();
+    return dispatchRules(config.rules, [&](auto rules) { return playTable<decltype(rules)>(seats, episodes, config); });
+}
+
+void printTableStats(std::ostream& out, const std::vector<Seat>& seats, const TableStats& stats) {
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << "Table training complete: " << stats.rounds << " rounds, " << stats.episodes << " learner episodes ("
+        << stats.seatHands << " seat hands), " << static_cast<long long>(stats.episodesPerSecond)
+        << " episodes/sec." << std::endl;
+    out << std::fixed << std::setprecision(4);
+    for (size_t s = 0; s < seats.size(); ++s) {
+        const Seat& seat = seats[s];
+        out << "  Seat " << s + 1 << " " << std::left << std::setw(9) << seat.kindName() << std::right
+            << std::setw(12) << seat.hands << " hands, EV " << (seat.hands > 0 ? seat.reward / seat.hands : 0)
+            << " per hand" << std::endl;
+    }
+    out.copyfmt(oldState);
+}
+
+void compareTableSeats(std::ostream& out, const QLearner& prototype, long long episodes, const TrainerConfig& config) {
+    // Only the learning is compared: nothing is checkpointed, logged or printed
+    TrainerConfig quiet;
+    quiet.log = nullptr;
+    quiet.decks = config.decks;
+    quiet.penetration = config.penetration;
+    quiet.lazyShuffle = config.lazyShuffle;
+    quiet.rules = config.rules;
+
+    struct Row {
+        int seats; // 0 for the single-seat trainer
+        long long rounds;
+        long long episodes;
+        double episodesPerSecond;
+        PolicyGrade grade;
+    };
+    std::vector<Row> rows;
+    {
+        QLearner ai = prototype;
+        TrainerStats stats = runSilentTrainer(ai, episodes, quiet);
+        rows.push_back({0, stats.hands, stats.hands, stats.handsPerSecond, gradePolicy(ai.qTable, config.decks)});
+    }
+    for (int n = 1; n <= MAX_SEATS; ++n) {
+        QLearner ai = prototype;
+        std::vector<Seat> seats(n);
+        for (Seat& seat : seats) seat.learner = &ai;
+        TableStats stats = runTableTrainer(seats, episodes, quiet);
+        rows.push_back({n, stats.rounds, stats.episodes, stats.episodesPerSecond, gradePolicy(ai.qTable, config.decks)});
+    }
+
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << "\n--- Table seats: " << episodes << " learner episodes each, exact EV of the greedy policy ---\n";
+    out << std::left << std::setw(14) << "Seats" << std::right << std::setw(12) << "Rounds" << std::setw(12)
+        << "Episodes" << std::setw(14) << "Episodes/sec" << std::setw(10) << "Speed-up" << std::setw(10) << "EV"
+        << "\n";
+    out << std::fixed;
+    double single = rows.front().episodesPerSecond;
+    for (const Row& row : rows) {
+        std::string label = row.seats == 0 ? "single-seat" : std::to_string(row.seats) + (row.seats == 1 ? " learner" : " learners");
+        out << std::left << std::setw(14) << label << std::right << std::setw(12) << row.rounds << std::setw(12)
+            << row.episodes << std::setw(14) << std::setprecision(0) << row.episodesPerSecond << std::setw(9)
+            << std::setprecision(2) << (single > 0 ? row.episodesPerSecond / single : 0) << "x" << std::setw(10)
+            << std::setprecision(4) << row.grade.policyEV << "\n";
+    }
+    out.copyfmt(oldState);
+    out.flush();
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "Telemetry.h"
+
+namespace {
+
+// How often the writer wakes to drain the queue. Waking it per sample would cost the
+// trainer a context switch every window, which on a busy core is most of the overhead.
+constexpr std::chrono::milliseconds WRITE_PERIOD(100);
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+TelemetryWriter::TelemetryWriter(const std::string& path) : TelemetryWriter(path, formatFor(path)) {}
+
+TelemetryWriter::TelemetryWriter(const std::string& path, TelemetryFormat format) : format(format) {
+    if (path == "-") {
+        toStdout = true;
+    } else {
+        file.open(path, std::ios::trunc);
+        if (!file) {
+            std::cerr << "Could not write telemetry to " << path << std::endl;
+            return;
+        }
+    }
+    open = true;
+    if (format == TelemetryFormat::Csv) {
+        emit("hands,seconds,window_hands,hands_per_second,win_rate,push_rate,loss_rate,updates,"
+             "mean_abs_dq,states_known,epsilon,alpha,simulate_s,update_s,persist_s\n");
+    }
+    writer = std::thread(&TelemetryWriter::run, this);
+}
+
+TelemetryWriter::~TelemetryWriter() {
+    if (!open) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+TelemetryFormat TelemetryWriter::formatFor(const std::string& path) {
+    return endsWith(path, ".json") || endsWith(path, ".jsonl") ? TelemetryFormat::JsonLines : TelemetryFormat::Csv;
+}
+
+void TelemetryWriter::submit(const TelemetrySample& sample) {
+    if (!open) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(sample);
+}
+
+long long TelemetryWriter::samplesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+void TelemetryWriter::run() {
+    std::vector<TelemetrySample> batch;
+    std::ostringstream text;
+    text << std::setprecision(6);
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait_for(lock, WRITE_PERIOD, [this]() { return stopping; });
+        if (pending.empty()) {
+            if (stopping) break; // Nothing left to write
+            continue;
+        }
+
+        batch.swap(pending);
+        lock.unlock();
+        // Formatted on a stream of our own and written in one piece, so no other thread's
+        // output or format state ever mixes with the rows
+        text.str("");
+        for (const auto& s : batch) write(text, s);
+        emit(text.str());
+        lock.lock();
+        written += static_cast<long long>(batch.size());
+        batch.clear();
+    }
+}
+
+void TelemetryWriter::emit(const std::string& text) {
+    // Flushed per batch so a long run can be followed with tail -f
+    if (toStdout) {
+        // The process's stdout itself: with "-", main points std::cout at stderr
+        std::fwrite(text.data(), 1, text.size(), stdout);
+        std::fflush(stdout);
+    } else {
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        file.flush();
+    }
+}
+
+void TelemetryWriter::write(std::ostream& out, const TelemetrySample& s) {
+    if (format == TelemetryFormat::Csv) {
+        out << s.hands << ',' << s.seconds << ',' << s.windowHands << ',' << s.handsPerSecond << ',' << s.winRate
+            << ',' << s.pushRate << ',' << s.lossRate << ',' << s.updates << ',' << s.meanAbsDeltaQ << ','
+            << s.statesKnown << ',' << s.epsilon << ',' << s.alpha << ',' << s.simulateSeconds << ','
+            << s.updateSeconds << ',' << s.persistSeconds << '\n';
+    } else {
+        out << "{\"hands\": " << s.hands << ", \"seconds\": " << s.seconds << ", \"window_hands\": " << s.windowHands
+            << ", \"hands_per_second\": " << s.handsPerSecond << ", \"win_rate\": " << s.winRate
+            << ", \"push_rate\": " << s.pushRate << ", \"loss_rate\": " << s.lossRate << ", \"updates\": " << s.updates
+            << ", \"mean_abs_dq\": " << s.meanAbsDeltaQ << ", \"states_known\": " << s.statesKnown
+            << ", \"epsilon\": " << s.epsilon << ", \"alpha\": " << s.alpha << ", \"simulate_s\": " << s.simulateSeconds
+            << ", \"update_s\": " << s.updateSeconds << ", \"persist_s\": " << s.persistSeconds << "}\n";
+    }
+}
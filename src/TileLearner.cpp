@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include "QTableStore.h"
+#include "TileLearner.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TILE_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int TILINGS = TileCoder::TILINGS;
+constexpr int HALF = TILINGS / 2;
+constexpr uint32_t HASH_SEED = 0x9E3779B1u;
+constexpr uint32_t HASH_MULTIPLIER = 0x85EBCA6Bu;
+
+// Tile widths per group, in feature units. Powers of two with offsets in
+// eighths keep every x * scale + offset exact in float, so the kernels agree
+// on every cell whether or not the compiler fuses the multiply-add.
+constexpr float BASIC_WIDTHS[TileCoder::FEATURES] = {2, 1, 1, 0}; // No count
+constexpr float COUNT_WIDTHS[TileCoder::FEATURES] = {4, 2, 1, 2};
+
+void stateFeatures(const CountState& s, float x[TileCoder::FEATURES]) {
+    x[0] = static_cast<float>(s.pTotal);
+    x[1] = static_cast<float>(s.dCard);
+    x[2] = s.soft ? 1.0f : 0.0f;
+    x[3] = static_cast<float>(s.countBucket);
+}
+
+void tilesScalar(const float x[TileCoder::FEATURES], const float (&scale)[TileCoder::FEATURES][TILINGS],
+                 const float (&offset)[TileCoder::FEATURES][TILINGS], int bits, uint32_t out[TILINGS]) {
+    for (int t = 0; t < TILINGS; ++t) {
+        uint32_t h = static_cast<uint32_t>(t + 1) * HASH_SEED;
+        for (int d = 0; d < TileCoder::FEATURES; ++d) {
+            int32_t cell = static_cast<int32_t>(std::floor(x[d] * scale[d][t] + offset[d][t]));
+            h = (h ^ static_cast<uint32_t>(cell)) * HASH_MULTIPLIER;
+        }
+        h ^= h >> 16;
+        out[t] = h >> (32 - bits);
+    }
+}
+
+// Sums tile l with tile l + 8, then folds 8 -> 4 -> 2 -> 1: the AVX2 reduction's order
+float sumScalar(const float* weights, const uint32_t tiles[TILINGS], int action) {
+    float lanes[HALF];
+    for (int l = 0; l < HALF; ++l) lanes[l] = weights[tiles[l] * 2 + action] + weights[tiles[l + HALF] * 2 + action];
+    float quarter[4];
+    for (int l = 0; l < 4; ++l) quarter[l] = lanes[l] + lanes[l + 4];
+    return (quarter[0] + quarter[2]) + (quarter[1] + quarter[3]);
+}
+
+#ifdef TILE_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2"))) void tilesAvx2(const float x[TileCoder::FEATURES],
+                                               const float (&scale)[TileCoder::FEATURES][TILINGS],
+                                               const float (&offset)[TileCoder::FEATURES][TILINGS], int bits,
+                                               uint32_t out[TILINGS]) {
+    const __m256i multiplier = _mm256_set1_epi32(static_cast<int>(HASH_MULTIPLIER));
+    for (int half = 0; half < 2; ++half) {
+        __m256i tiling = _mm256_add_epi32(_mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8), _mm256_set1_epi32(half * HALF));
+        __m256i h = _mm256_mullo_epi32(tiling, _mm256_set1_epi32(static_cast<int>(HASH_SEED)));
+        for (int d = 0; d < TileCoder::FEATURES; ++d) {
+            __m256 v = _mm256_mul_ps(_mm256_set1_ps(x[d]), _mm256_load_ps(&scale[d][half * HALF]));
+            v = _mm256_add_ps(v, _mm256_load_ps(&offset[d][half * HALF]));
+            __m256i cell = _mm256_cvttps_epi32(_mm256_floor_ps(v));
+            h = _mm256_mullo_epi32(_mm256_xor_si256(h, cell), multiplier);
+        }
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+        h = _mm256_srli_epi32(h, 32 - bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + half * HALF), h);
+    }
+}
+
+__attribute__((target("avx2"))) float sumAvx2(const float* weights, const uint32_t tiles[TILINGS], int action) {
+    const __m256i base = _mm256_set1_epi32(action);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tiles));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tiles + HALF));
+    lo = _mm256_add_epi32(_mm256_slli_epi32(lo, 1), base);
+    hi = _mm256_add_epi32(_mm256_slli_epi32(hi, 1), base);
+    __m256 lanes = _mm256_add_ps(_mm256_i32gather_ps(weights, lo, 4), _mm256_i32gather_ps(weights, hi, 4));
+    __m128 quarter = _mm_add_ps(_mm256_castps256_ps128(lanes), _mm256_extractf128_ps(lanes, 1));
+    __m128 pair = _mm_add_ps(quarter, _mm_movehl_ps(quarter, quarter));
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+}
+
+bool cpuHasAvx2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+bool cpuHasAvx2() {
+    return false;
+}
+
+#endif
+
+} // namespace
+
+TileCoder::TileCoder(int bits) : bits(std::max(1, std::min(bits, 24))), useAvx2(cpuHasAvx2()) {
+    for (int t = 0; t < TILINGS; ++t) {
+        const float* widths = t < HALF ? BASIC_WIDTHS : COUNT_WIDTHS;
+        int k = t % HALF;
+        for (int d = 0; d < FEATURES; ++d) {
+            scale[d][t] = widths[d] > 0 ? 1.0f / widths[d] : 0.0f;
+            // Asymmetric offsets (k * (2d + 1) eighths of a tile) so no two tilings line up on any feature
+            offset[d][t] = static_cast<float>((k * (2 * d + 1)) % HALF) / HALF;
+        }
+    }
+}
+
+void TileCoder::setUseAvx2(bool enabled) {
+    useAvx2 = enabled && cpuHasAvx2();
+}
+
+void TileCoder::tiles(const CountState& s, uint32_t out[TILINGS]) const {
+    float x[FEATURES];
+    stateFeatures(s, x);
+#ifdef TILE_HAVE_AVX2_KERNEL
+    if (useAvx2) {
+        tilesAvx2(x, scale, offset, bits, out);
+        return;
+    }
+#endif
+    tilesScalar(x, scale, offset, bits, out);
+}
+
+void TileCoder::values(const float* weights, const uint32_t tiles[TILINGS], double q[2]) const {
+#ifdef TILE_HAVE_AVX2_KERNEL
+    if (useAvx2) {
+        q[0] = sumAvx2(weights, tiles, 0);
+        q[1] = sumAvx2(weights, tiles, 1);
+        return;
+    }
+#endif
+    q[0] = sumScalar(weights, tiles, 0);
+    q[1] = sumScalar(weights, tiles, 1);
+}
+
+TileLearner::TileLearner(int bits)
+    : coder(bits), weights(coder.weightCount() * 2, 0.0f), visits(coder.weightCount() * 2, 0) {}
+
+void TileLearner::qValues(const CountState& s, double q[2]) const {
+    uint32_t cells[TILINGS];
+    coder.tiles(s, cells);
+    coder.values(weights.data(), cells, q);
+}
+
+int TileLearner::decide(const CountState& s, bool training) {
+    if (training && rng.uniform() < epsilon) {
+        return static_cast<int>(rng.below(2));
+    }
+    double q[2];
+    qValues(s, q);
+    return (q[1] > q[0]) ? 1 : 0;
+}
+
+void TileLearner::update(const CountState& s, int action, double reward, const CountState& nextS, bool isDone) {
+    double maxNextQ = 0;
+    if (!isDone) {
+        double next[2];
+        qValues(nextS, next);
+        maxNextQ = std::max(next[0], next[1]);
+    }
+    uint32_t cells[TILINGS];
+    coder.tiles(s, cells);
+    double q[2];
+    coder.values(weights.data(), cells, q);
+    double error = reward + gamma * maxNextQ - q[action];
+
+    // AVX2 has no scatter, and 16 adds are cheaper than emulating one
+    for (int t = 0; t < TILINGS; ++t) {
+        size_t w = static_cast<size_t>(cells[t]) * 2 + action;
+        uint32_t& n = visits[w];
+        if (n < UINT32_MAX) ++n;
+        double rate = std::max(alpha, 1.0 / n) / TILINGS;
+        weights[w] += static_cast<float>(rate * error);
+    }
+}
+
+void TileLearner::exportPolicy(CountQTable& table) const {
+    for (int i = 0; i < CountQTable::STATES; ++i) {
+        State basic = QTable::stateAt(i % CountQTable::STATES_PER_BUCKET);
+        CountState s = {basic.pTotal, basic.dCard, basic.hasAce, i / CountQTable::STATES_PER_BUCKET};
+        double q[2];
+        qValues(s, q);
+        double* out = table.at(i);
+        out[0] = q[0];
+        out[1] = q[1];
+        table.markKnown(i);
+    }
+}
+
+size_t TileLearner::memoryBytes() const {
+    return sizeof(*this) + weights.size() * sizeof(float) + visits.size() * sizeof(uint32_t);
+}
+
+bool TileLearner::save(QTableStore& store) const {
+    return store.saveWeights("tiles-" + std::to_string(coder.getBits()), weights);
+}
+
+bool TileLearner::load(QTableStore& store) {
+    std::vector<float> stored;
+    if (!store.loadWeights("tiles-" + std::to_string(coder.getBits()), stored)) return false;
+    if (stored.size() != weights.size()) {
+        std::cerr << "Stored tile weights do not match a " << coder.getBits() << "-bit tile coder" << std::endl;
+        return false;
+    }
+    weights = stored;
+    return true;
+}
+
+void runTileTrainer(TileLearner& ai, long long hands, const TrainerConfig& config) {
+    std::ostream& log = trainerLog(config);
+    log << "Training tile-coding AI for " << hands << " hands on a " << config.decks << "-deck shoe..." << std::endl;
+    Shoe shoe(config.decks, config.penetration, config.lazyShuffle, streamRng(STREAM_COUNT_SHOE));
+    auto decide = [&ai](const CountState& s) { return ai.decide(s, true); };
+    auto learn = [&ai](const CountState& s, int action, double reward, const CountState& nextS, bool isDone) {
+        ai.update(s, action, reward, nextS, isDone);
+    };
+    int bucket;
+    for (long long i = 0; i < hands; ++i) playCountHand(shoe, true, decide, learn, bucket);
+    log << "Training complete." << std::endl;
+}
+
+void compareTileLearner(std::ostream& out, long long hands, int stages, long long evalHands, int bits,
+                        const TrainerConfig& config, TileLearner* trained) {
+    stages = std::max(1, stages);
+    TrainerConfig quiet = config;
+    quiet.log = nullptr;
+    TileLearner sizing(bits);
+    size_t tileBytes = sizing.memoryBytes();
+    size_t tableBytes = sizeof(CountLearner) + CountQTable::STATES * CountQTable::ACTIONS * sizeof(uint32_t);
+
+    std::ios oldState(nullptr);
+    oldState.copyfmt(out);
+    out << std::fixed << std::setprecision(1);
+    out << "Memory:  tile coding " << tileBytes / 1024.0 << " KB (" << TileCoder::TILINGS << " tilings into "
+        << sizing.coder.weightCount() << " cells), table " << tableBytes / 1024.0 << " KB ("
+        << CountQTable::STATES << " states)" << std::endl;
+    out << std::setprecision(4);
+    out << "   Hands     tile EV    +/-       table EV   +/-      Time (s)" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int stage = stages - 1; stage >= 0; --stage) {
+        long long n = std::max(1LL, hands >> stage);
+        // Both tables are large; keep them off the stack
+        std::unique_ptr<TileLearner> tiles(new TileLearner(bits));
+        std::unique_ptr<CountLearner> table(new CountLearner());
+        std::unique_ptr<CountQTable> policy(new CountQTable());
+        runTileTrainer(*tiles, n, quiet);
+        runCountTrainer(*table, n, quiet);
+        tiles->exportPolicy(*policy);
+        CountEvalResult tileResult =
+            evaluateCountPolicy(*policy, true, evalHands, config.decks, config.penetration, config.threads);
+        CountEvalResult tableResult =
+            evaluateCountPolicy(table->qTable, true, evalHands, config.decks, config.penetration, config.threads);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        out << std::setw(8) << n << std::setw(12) << tileResult.ev << std::setw(8) << tileResult.stdError
+            << std::setw(12) << tableResult.ev << std::setw(8) << tableResult.stdError << std::setw(12)
+            << std::setprecision(1) << elapsed.count() << std::setprecision(4) << std::endl;
+        if (stage == 0 && trained) *trained = std::move(*tiles);
+    }
+    out.copyfmt(oldState);
+}
@@ -1,51 +1,761 @@
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Trainer.h"
+#include "AtomicQTable.h"
+#include "HandHistory.h"
+#include "LearnerAlgorithms.h"
 #include "QLearner.h"
-#include "Deck.h"
+#include "QTableStore.h"
+#include "ReplayBuffer.h"
+#include "RuleSet.h"
+#include "SharedQTable.h"
+#include "Shoe.h"
+#include "Random.h"
 #include "Hand.h"
+#include "Telemetry.h"
+#include "WorkShare.h"
 
-void runSilentTrainer(QLearner& ai, int totalHands) {
-    std::cout << "Training AI for " << totalHands << " hands..." << std::endl;
-
-    for (int i = 0; i < totalHands; ++i) {
-        Deck deck;
-        deck.shuffle();
-        Hand player, dealer;
-
-        // Initial Deal
-        player.addCard(deck.dealCard());
-        dealer.addCard(deck.dealCard());
-        player.addCard(deck.dealCard());
-        dealer.addCard(deck.dealCard());
-
-        State currentState = {player.getTotal(), dealer.getCard(0).getValue(), false};
-        
-        // Player's Turn
-        while (!player.isBust()) {
-            int action = ai.decide(currentState, true);
-            if (action == 0) break; // Stand
-
-            player.addCard(deck.dealCard());
-            State nextState = {player.getTotal(), dealer.getCard(0).getValue(), false};
-            
-            if (player.isBust()) {
-                ai.update(currentState, 1, -1.0, nextState, true);
-            } else {
-                ai.update(currentState, 1, 0, nextState, false);
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// One hand in this many is timed phase by phase for telemetry. Reading the
+// clock around every update would cost more than the telemetry is allowed to.
+constexpr int TELEMETRY_TIMING_SAMPLE = 1024;
+
+// Hand-based epsilon/alpha schedules are re-evaluated every this many hands
+constexpr int SCHEDULE_STEP = 256;
+
+// Swallows the output of a quiet trainer
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// What one thread saw since the last telemetry sample. Kept up to date on
+// every hand; it is a handful of adds, so there is no switch to turn it off.
+struct HandTally {
+    long long hands = 0;
+    long long wins = 0;
+    long long pushes = 0;
+    long long losses = 0;
+    long long updates = 0;
+    double absDeltaQ = 0;
+    long long timedHands = 0;
+    double timedSeconds = 0;       // Wall time of the timed hands
+    double timedUpdateSeconds = 0; // The part of it spent in updates
+    double persistSeconds = 0;
+
+    void add(const HandTally& other) {
+        hands += other.hands;
+        wins += other.wins;
+        pushes += other.pushes;
+        losses += other.losses;
+        updates += other.updates;
+        absDeltaQ += other.absDeltaQ;
+        timedHands += other.timedHands;
+        timedSeconds += other.timedSeconds;
+        timedUpdateSeconds += other.timedUpdateSeconds;
+        persistSeconds += other.persistSeconds;
+    }
+};
+
+// Plays one training hand under Rules, feeding every transition back into the agent.
+// Agent needs decide(State, bool) and update(State, int, double, State, bool),
+// with update returning the change it made.
+template <typename Rules, typename Agent>
+void playTrainingHand(Agent& ai, Shoe& shoe, HandTally& tally, HandHistoryBlock* history = nullptr) {
+    bool reshuffled = shoe.prepareRound();
+    Hand player, dealer;
+
+    // Initial Deal
+    player.addCard(shoe.dealCard());
+    dealer.addCard(shoe.dealCard());
+    player.addCard(shoe.dealCard());
+    dealer.addCard(shoe.dealCard());
+
+    // Naturals (and, with peek, the dealer's) end the hand before there is anything to learn
+    HandOutcome opening;
+    double openingReward;
+    if (Rules::settleDeal(player, dealer, opening, openingReward)) {
+        ++tally.hands;
+        if (openingReward > 0) ++tally.wins;
+        else if (openingReward < 0) ++tally.losses;
+        else ++tally.pushes;
+        if (history) history->record(player, dealer, opening, reshuffled);
+        return;
+    }
+
+    State currentState = {player.getTotal(), dealer.getCard(0).getValue(), false};
+
+    // Player's Turn
+    while (!player.isBust()) {
+        int action = ai.decide(currentState, true);
+        if (action == 0) break; // Stand
+
+        player.addCard(shoe.dealCard());
+        State nextState = {player.getTotal(), dealer.getCard(0).getValue(), false};
+
+        if (player.isBust()) {
+            tally.absDeltaQ += std::abs(ai.update(currentState, 1, -1.0, nextState, true));
+        } else {
+            tally.absDeltaQ += std::abs(ai.update(currentState, 1, 0, nextState, false));
+        }
+        ++tally.updates;
+        currentState = nextState;
+    }
+
+    // Dealer's Turn & Final Reward
+    ++tally.hands;
+    if (!player.isBust()) {
+        while (Rules::dealerDraws(dealer)) dealer.addCard(shoe.dealCard());
+
+        double reward = 0;
+        if (dealer.isBust() || player.getTotal() > dealer.getTotal()) reward = 1.0;
+        else if (player.getTotal() < dealer.getTotal()) reward = -1.0;
+
+        tally.absDeltaQ += std::abs(ai.update(currentState, 0, reward, currentState, true));
+        ++tally.updates;
+        if (reward > 0) ++tally.wins;
+        else if (reward < 0) ++tally.losses;
+        else ++tally.pushes;
+    } else {
+        ++tally.losses;
+    }
+
+    if (history) history->record(player, dealer, settleHand(player, dealer), reshuffled);
+}
+
+// Times the agent's updates on the hands picked for timing
+template <typename Agent>
+struct TimedAgent {
+    Agent& ai;
+    double& seconds;
+
+    int decide(State s, bool training) { return ai.decide(s, training); }
+
+    double update(State s, int action, double reward, State nextS, bool isDone) {
+        auto start = Clock::now();
+        double step = ai.update(s, action, reward, nextS, isDone);
+        seconds += secondsSince(start);
+        return step;
+    }
+};
+
+// playTrainingHand, timed phase by phase when `timed` is set
+template <typename Rules, typename Agent>
+void playMeteredHand(Agent& ai, Shoe& shoe, HandTally& tally, bool timed, HandHistoryBlock* history) {
+    if (!timed) {
+        playTrainingHand<Rules>(ai, shoe, tally, history);
+        return;
+    }
+    auto start = Clock::now();
+    TimedAgent<Agent> agent{ai, tally.timedUpdateSeconds};
+    playTrainingHand<Rules>(agent, shoe, tally, history);
+    tally.timedSeconds += secondsSince(start);
+    ++tally.timedHands;
+}
+
+// Turns tallies into TelemetrySamples for config.telemetry
+class TelemetryMeter {
+public:
+    explicit TelemetryMeter(const TrainerConfig& config)
+        : writer(config.telemetry), interval(std::max(1, config.telemetryInterval)),
+          start(Clock::now()), windowStart(start) {}
+
+    bool enabled() const { return writer != nullptr; }
+    int getInterval() const { return interval; }
+    bool timeHand(long long i) const { return writer && i % TELEMETRY_TIMING_SAMPLE == 0; }
+
+    // Sends the window and starts the next one. `hands` is the running total;
+    // a window from one thread of `scale` equal threads stands for all of them.
+    void emit(const HandTally& window, long long hands, int statesKnown, double epsilon, double alpha,
+              int scale = 1) {
+        if (!writer || window.hands == 0) return;
+        auto now = Clock::now();
+        double wall = std::chrono::duration<double>(now - windowStart).count();
+        windowStart = now;
+
+        TelemetrySample s;
+        s.hands = hands;
+        s.seconds = std::chrono::duration<double>(now - start).count();
+        s.windowHands = window.hands * scale;
+        s.handsPerSecond = wall > 0 ? s.windowHands / wall : 0;
+        s.winRate = static_cast<double>(window.wins) / window.hands;
+        s.pushRate = static_cast<double>(window.pushes) / window.hands;
+        s.lossRate = static_cast<double>(window.losses) / window.hands;
+        s.updates = window.updates * scale;
+        s.meanAbsDeltaQ = window.updates > 0 ? window.absDeltaQ / window.updates : 0;
+        s.statesKnown = statesKnown;
+        s.epsilon = epsilon;
+        s.alpha = alpha;
+        // The timed hands give the update share of the time that was not spent persisting
+        s.persistSeconds = std::min(wall, window.persistSeconds);
+        double compute = wall - s.persistSeconds;
+        double updateShare = window.timedSeconds > 0 ? window.timedUpdateSeconds / window.timedSeconds : 0;
+        s.updateSeconds = compute * updateShare;
+        s.simulateSeconds = compute - s.updateSeconds;
+        writer->submit(s);
+    }
+
+private:
+    TelemetryWriter* writer;
+    int interval;
+    Clock::time_point start;
+    Clock::time_point windowStart;
+};
+
+// Applies the config's early-stopping rules, one check window at a time
+class ConvergenceMonitor {
+public:
+    explicit ConvergenceMonitor(const TrainerConfig& config)
+        : interval(std::max(1, config.stopCheckInterval)), patience(config.stopPatience),
+          tolerance(config.stopPolicyTolerance), deltaQ(config.stopDeltaQ) {
+        policy.fill(NO_ACTION);
+    }
+
+    bool enabled() const { return patience > 0 || deltaQ > 0; }
+    int getInterval() const { return interval; }
+    const std::string& getReason() const { return reason; }
+
+    // True once a rule is met. Each call also remembers the greedy policy for the next one,
+    // so the first check never counts as stable.
+    bool check(const QTable& table, const HandTally& window) {
+        int known = 0;
+        int changed = 0;
+        for (int i = 0; i < QTable::STATES; ++i) {
+            if (!table.isKnown(i)) continue;
+            const double* q = table.at(i);
+            uint8_t action = (q[1] > q[0]) ? 1 : 0;
+            ++known;
+            if (policy[i] != action) ++changed;
+            policy[i] = action;
+        }
+        stableChecks = (known > 0 && changed <= tolerance * known) ? stableChecks + 1 : 0;
+        if (patience > 0 && stableChecks >= patience) {
+            reason = "policy stable for " + std::to_string(stableChecks) + " checks";
+            return true;
+        }
+        double meanDeltaQ = window.updates > 0 ? window.absDeltaQ / window.updates : 0;
+        if (deltaQ > 0 && window.updates > 0 && meanDeltaQ < deltaQ) {
+            reason = "mean |dQ| " + std::to_string(meanDeltaQ) + " below " + std::to_string(deltaQ);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static constexpr uint8_t NO_ACTION = 2;
+    int interval;
+    int patience;
+    double tolerance;
+    double deltaQ;
+    int stableChecks = 0;
+    std::array<uint8_t, QTable::STATES> policy;
+    std::string reason;
+};
+
+// Hands are tallied into `current`, which is passed on every few hands to the telemetry
+// meter and the convergence monitor; each keeps its own window length.
+class TrainingWindows {
+public:
+    // With `scale` > 1, one thread's hands stand for `scale` equal threads (shared mode)
+    TrainingWindows(const TrainerConfig& config, int scale = 1) : meter(config), monitor(config), scale(scale) {
+        telemetryHands = meter.enabled() ? std::max(1, meter.getInterval() / scale) : 0;
+        checkHands = monitor.enabled() ? std::max(1, monitor.getInterval() / scale) : 0;
+        step = (telemetryHands > 0 && checkHands > 0) ? std::gcd(telemetryHands, checkHands)
+                                                      : std::max(telemetryHands, checkHands);
+        untilStep = step;
+    }
+
+    HandTally current;
+
+    bool timeHand(long long i) const { return meter.timeHand(i); }
+    bool stopping() const { return monitor.enabled(); }
+    bool converged() const { return stopped; }
+    const std::string& getReason() const { return monitor.getReason(); }
+    // True when the hand just played should be followed by close(). Called once per hand, so it
+    // counts down instead of dividing the hand number by the step
+    bool endsStep(bool last) {
+        if (step == 0) return false;
+        if (--untilStep > 0) return last;
+        untilStep = step;
+        return true;
+    }
+
+    // Passes `current` on. `hands` is the running total; `table` returns the QTable to
+    // check, and is only called when a check or sample is due. Returns true to stop.
+    template <typename TableFn>
+    bool close(long long hands, bool last, double epsilon, double alpha, TableFn table) {
+        telemetryWindow.add(current);
+        checkWindow.add(current);
+        current = HandTally();
+        if (checkHands > 0 && checkWindow.hands >= checkHands) {
+            stopped = monitor.check(table(), checkWindow);
+            checkWindow = HandTally();
+        }
+        if (telemetryHands > 0 && (telemetryWindow.hands >= telemetryHands || last || stopped)) {
+            meter.emit(telemetryWindow, hands, table().size(), epsilon, alpha, scale);
+            telemetryWindow = HandTally();
+        }
+        return stopped;
+    }
+
+private:
+    TelemetryMeter meter;
+    ConvergenceMonitor monitor;
+    int scale;
+    int telemetryHands;
+    int checkHands;
+    int step;
+    int untilStep;
+    HandTally telemetryWindow;
+    HandTally checkWindow;
+    bool stopped = false;
+};
+
+// Prints how training ended and, with early stopping, what it saved over the full budget
+void reportStop(std::ostream& log, const TrainerStats& stats, const TrainingWindows& windows) {
+    if (!windows.stopping()) return;
+    if (!stats.converged) {
+        log << "Did not converge within " << stats.budget << " hands." << std::endl;
+        return;
+    }
+    long long saved = stats.budget - stats.hands;
+    log << "Converged after " << stats.hands << " hands (" << windows.getReason() << "): saved " << saved
+              << " of " << stats.budget << " hands ("
+              << (stats.budget > 0 ? std::round(1000.0 * saved / stats.budget) / 10 : 0) << "%)." << std::endl;
+}
+
+// Hands go into a per-thread block and reach the writer in large pieces
+void flushHistory(const TrainerConfig& config, HandHistoryBlock& block) {
+    if (!config.history || block.size() == 0) return;
+    config.history->append(block);
+    block.clear();
+}
+
+// Learns from each transition online through `inner`, and keeps it for replay
+template <typename Inner>
+struct ReplayAgent {
+    Inner& inner;
+    ReplayBuffer& buffer;
+
+    int decide(State s, bool training) { return inner.decide(s, training); }
+
+    double update(State s, int action, double reward, State nextS, bool isDone) {
+        double step = inner.update(s, action, reward, nextS, isDone);
+        buffer.add(makeTransition(s, action, reward, nextS, isDone));
+        return step;
+    }
+};
+
+// Per-thread copy of the learner for shadow mode. Visit counts let the merge
+// weight each thread's values by how much evidence it actually saw.
+struct ShadowAgent {
+    QLearner table;
+    std::vector<long long> visits; // Per state-action, laid out like QTable
+
+    ShadowAgent(const QLearner& master, const Rng& rng)
+        : table(master), visits(QTable::STATES * QTable::ACTIONS, 0) {
+        table.rng = rng;
+    }
+
+    int decide(State s, bool training) { return table.decide(s, training); }
+
+    double update(State s, int action, double reward, State nextS, bool isDone) {
+        visits[QTable::index(s) * QTable::ACTIONS + action]++;
+        return table.update(s, action, reward, nextS, isDone);
+    }
+};
+
+// Thread view onto the shared atomic table, with its own exploration RNG
+struct SharedAgent {
+    AtomicQTable& table;
+    double alpha, gamma, epsilon;
+    Rng rng;
+
+    int decide(State s, bool training) {
+        if (training && rng.uniform() < epsilon) {
+            return static_cast<int>(rng.below(2));
+        }
+        return (table.get(s, 1) > table.get(s, 0)) ? 1 : 0;
+    }
+
+    double update(State s, int action, double reward, State nextS, bool isDone) {
+        double maxNextQ = isDone ? 0 : std::max(table.get(nextS, 0), table.get(nextS, 1));
+        return table.update(s, action, reward, gamma, alpha, maxNextQ);
+    }
+};
+
+Shoe makeShoe(const TrainerConfig& config, int thread) {
+    return Shoe(config.decks, config.penetration, config.lazyShuffle, streamRng(STREAM_TRAINER + 2 * thread));
+}
+
+Rng explorationRng(int thread) {
+    return streamRng(STREAM_TRAINER + 2 * thread + 1);
+}
+
+// Deterministic for a given seed, thread count and sync interval: threads never
+// touch each other's data and the merge visits them in a fixed order.
+// Returns the hands played; convergence is only checked between rounds.
+template <typename Rules>
+long long trainShadow(QLearner& ai, long long totalHands, const TrainerConfig& config, int threads,
+                      TrainingWindows& windows) {
+    int syncInterval = std::max(1, config.syncInterval);
+    // Shoes and RNG streams outlive the sync rounds so each thread keeps dealing through its shoe
+    std::vector<Shoe> shoes;
+    std::vector<Rng> rngs;
+    for (int t = 0; t < threads; ++t) {
+        shoes.push_back(makeShoe(config, t));
+        rngs.push_back(explorationRng(t));
+    }
+
+    std::vector<HandHistoryBlock> histories(config.history ? threads : 0);
+
+    long long remaining = totalHands;
+    long long sinceCheckpoint = 0;
+    while (remaining > 0) {
+        long long played = totalHands - remaining;
+        long long roundHands = std::min(remaining, static_cast<long long>(syncInterval) * threads);
+        remaining -= roundHands;
+
+        ai.advanceSchedules(played);
+        std::vector<ShadowAgent> agents;
+        agents.reserve(threads);
+        for (int t = 0; t < threads; ++t) agents.emplace_back(ai, rngs[t]);
+
+        std::vector<HandTally> tallies(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            long long hands = shareOf(roundHands, threads, t);
+            workers.emplace_back([&agents, &shoes, &histories, &tallies, &windows, t, hands, played, threads]() {
+                HandHistoryBlock* history = histories.empty() ? nullptr : &histories[t];
+                for (long long i = 0; i < hands; ++i) {
+                    // The threads play side by side, so hand i of each is roughly hand i * threads overall
+                    if (i % SCHEDULE_STEP == 0) agents[t].table.advanceSchedules(played + i * threads);
+                    playMeteredHand<Rules>(agents[t], shoes[t], tallies[t], windows.timeHand(i), history);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        for (const auto& tally : tallies) windows.current.add(tally);
+        auto persistStart = Clock::now();
+        // Appended in thread order, so the log is as reproducible as the training
+        for (auto& block : histories) flushHistory(config, block);
+        for (int t = 0; t < threads; ++t) rngs[t] = agents[t].table.rng;
+
+        // Merge: each state-action becomes the visit-weighted mean of the thread copies
+        for (int i = 0; i < QTable::STATES; ++i) {
+            for (int a = 0; a < QTable::ACTIONS; ++a) {
+                double weighted = 0;
+                long long count = 0;
+                for (const auto& agent : agents) {
+                    long long n = agent.visits[i * QTable::ACTIONS + a];
+                    weighted += agent.table.qTable.at(i)[a] * n;
+                    count += n;
+                }
+                if (count > 0) {
+                    ai.qTable.at(i)[a] = weighted / count;
+                    ai.qTable.markKnown(i);
+                }
+                // Visit-based schedules carry on from everything the threads saw
+                if (!ai.visits.empty()) ai.visits[i * QTable::ACTIONS + a] += static_cast<uint32_t>(count);
+            }
+        }
+
+        sinceCheckpoint += roundHands;
+        if (config.checkpointer && config.checkpointInterval > 0 && sinceCheckpoint >= config.checkpointInterval) {
+            config.checkpointer->submit(ai.qTable);
+            sinceCheckpoint = 0;
+        }
+        // The merge is where shadow mode pays for its threads, so it counts with persisting
+        windows.current.persistSeconds += secondsSince(persistStart);
+        if (windows.close(totalHands - remaining, remaining == 0, ai.epsilon, ai.alpha,
+                          [&ai]() -> const QTable& { return ai.qTable; })) {
+            break;
+        }
+    }
+    return totalHands - remaining;
+}
+
+// Not bit-for-bit reproducible: the interleaving of atomic updates depends on scheduling.
+// Telemetry and convergence checks come from thread 0's share of the hands, scaled up to
+// all threads; when it converges the others stop at their next hand. Thread t deals and
+// explores from the streams of thread firstThread + t, so processes sharing one table
+// each get their own. With `segment` set, thread 0 checkpoints only while this process
+// leads it, so leadership passes on when the leader leaves or a lower slot is taken.
+template <typename Rules>
+long long trainShared(QLearner& ai, AtomicQTable& table, long long totalHands, const TrainerConfig& config, int threads,
+                      int firstThread, TrainingWindows& windows, const SharedQTable* segment = nullptr) {
+    std::atomic<bool> converged{false};
+    std::vector<long long> played(threads, 0);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        long long hands = shareOf(totalHands, threads, t);
+        workers.emplace_back([&table, &ai, &config, &windows, &converged, &played, segment, hands, t, threads,
+                              firstThread]() {
+            SharedAgent agent{table, ai.alpha, ai.gamma, ai.epsilon, explorationRng(firstThread + t)};
+            Shoe shoe = makeShoe(config, firstThread + t);
+            // Thread 0 snapshots the shared table on behalf of everyone; the others never pause
+            bool checkpoints = t == 0 && config.checkpointer && config.checkpointInterval > 0;
+            int interval = std::max(1, config.checkpointInterval / threads);
+            QTable snapshot;
+            HandHistoryBlock block;
+            HandHistoryBlock* history = config.history ? &block : nullptr;
+            // Likewise for telemetry and convergence
+            TrainingWindows idle{TrainerConfig()};
+            TrainingWindows& own = t == 0 ? windows : idle;
+            long long i = 0;
+            for (; i < hands && !converged.load(std::memory_order_relaxed); ++i) {
+                if (i % SCHEDULE_STEP == 0) {
+                    long long overall = i * threads;
+                    if (ai.epsilonSchedule.byHands()) agent.epsilon = ai.epsilonSchedule.at(static_cast<double>(overall));
+                    if (ai.alphaSchedule.byHands()) agent.alpha = ai.alphaSchedule.at(static_cast<double>(overall));
+                }
+                playMeteredHand<Rules>(agent, shoe, own.current, own.timeHand(i), history);
+                if (checkpoints && (i + 1) % interval == 0 && (!segment || segment->leads())) {
+                    auto persistStart = Clock::now();
+                    table.storeTo(snapshot);
+                    config.checkpointer->submit(snapshot);
+                    own.current.persistSeconds += secondsSince(persistStart);
+                }
+                if (block.size() >= HandHistoryWriter::BLOCK_BYTES) {
+                    auto persistStart = Clock::now();
+                    flushHistory(config, block);
+                    own.current.persistSeconds += secondsSince(persistStart);
+                }
+                if (own.endsStep(i + 1 == hands)) {
+                    bool stop = own.close((i + 1) * threads, i + 1 == hands, agent.epsilon,
+                                          agent.alpha, [&]() -> const QTable& {
+                                              table.storeTo(snapshot);
+                                              return snapshot;
+                                          });
+                    if (stop) converged.store(true, std::memory_order_relaxed);
+                }
+            }
+            played[t] = i;
+            flushHistory(config, block);
+        });
+    }
+    for (auto& w : workers) w.join();
+    return std::accumulate(played.begin(), played.end(), 0LL);
+}
+
+// The single-threaded trainer, instantiated once per rule set and learner algorithm
+template <typename Rules, typename Agent>
+TrainerStats trainSilent(QLearner& ai, Agent& learner, long long totalHands, const TrainerConfig& config) {
+    Shoe shoe = makeShoe(config, 0);
+    ai.rng = explorationRng(0);
+    bool checkpoints = config.checkpointer && config.checkpointInterval > 0;
+    if (config.history) config.history->beginSession(HistorySource::Training, getMasterSeed(), config.decks, config.rules);
+    HandHistoryBlock block;
+    HandHistoryBlock* history = config.history ? &block : nullptr;
+
+    std::unique_ptr<ReplayBuffer> buffer;
+    if (config.replayCapacity > 0) {
+        buffer.reset(new ReplayBuffer(config.replayCapacity, config.replayPrioritized ? ReplaySampling::Prioritized
+                                                                                      : ReplaySampling::Uniform));
+    }
+    ReplayBatch batch;
+    TrainingWindows windows(config);
+    HandTally& window = windows.current;
+    auto start = Clock::now();
+
+    long long played = 0;
+    while (played < totalHands) {
+        long long i = played++;
+        if (i % SCHEDULE_STEP == 0) ai.advanceSchedules(i);
+        bool timed = windows.timeHand(i);
+        if (buffer) {
+            ReplayAgent<Agent> agent{learner, *buffer};
+            playMeteredHand<Rules>(agent, shoe, window, timed, history);
+            Clock::time_point replayStart;
+            if (timed) replayStart = Clock::now();
+            for (int b = 0; b < config.replayBatches; ++b) {
+                replayBatch(ai, *buffer, batch, config.replayBatchSize, config.replayRate);
+            }
+            if (timed) {
+                double seconds = secondsSince(replayStart);
+                window.timedSeconds += seconds;
+                window.timedUpdateSeconds += seconds;
             }
-            currentState = nextState;
+        } else {
+            playMeteredHand<Rules>(learner, shoe, window, timed, history);
         }
+        if (checkpoints && (i + 1) % config.checkpointInterval == 0) {
+            auto persistStart = Clock::now();
+            config.checkpointer->submit(ai.qTable);
+            window.persistSeconds += secondsSince(persistStart);
+        }
+        if (block.size() >= HandHistoryWriter::BLOCK_BYTES) {
+            auto persistStart = Clock::now();
+            flushHistory(config, block);
+            window.persistSeconds += secondsSince(persistStart);
+        }
+        if (windows.endsStep(played == totalHands) &&
+            windows.close(played, played == totalHands, ai.epsilon, ai.alpha,
+                          [&ai]() -> const QTable& { return ai.qTable; })) {
+            break;
+        }
+    }
+    flushHistory(config, block);
+    learner.finish();
+
+    TrainerStats stats;
+    stats.hands = played;
+    stats.budget = totalHands;
+    stats.converged = windows.converged();
+    stats.seconds = secondsSince(start);
+    stats.handsPerSecond = stats.seconds > 0 ? played / stats.seconds : 0;
+    std::ostream& log = trainerLog(config);
+    log << "Training complete. Q-Table size: " << ai.qTable.size() << " states." << std::endl;
+    reportStop(log, stats, windows);
+    return stats;
+}
+
+} // namespace
+
+std::ostream& trainerLog(const TrainerConfig& config) {
+    if (config.log) return *config.log;
+    // One per thread, so quiet trainers on several threads never share a stream
+    thread_local NullBuffer sink;
+    thread_local std::ostream quiet(&sink);
+    return quiet;
+}
 
-        // Dealer's Turn & Final Reward
-        if (!player.isBust()) {
-            while (dealer.getTotal() < 17) dealer.addCard(deck.dealCard());
+TrainerStats runSilentTrainer(QLearner& ai, long long totalHands, const TrainerConfig& config) {
+    std::ostream& log = trainerLog(config);
+    log << "Training AI for " << totalHands << " hands";
+    if (config.algorithm != LearnerAlgorithm::QLearning) log << " with " << algorithmName(config.algorithm);
+    log << "..." << std::endl;
 
-            double reward = 0;
-            if (dealer.isBust() || player.getTotal() > dealer.getTotal()) reward = 1.0;
-            else if (player.getTotal() < dealer.getTotal()) reward = -1.0;
+    // Replayed batches are Q-learning updates on ai.qTable, which only suits Q-learning itself
+    TrainerConfig own = config;
+    if (own.replayCapacity > 0 && own.algorithm != LearnerAlgorithm::QLearning) {
+        log << "Experience replay only runs with Q-learning; ignored." << std::endl;
+        own.replayCapacity = 0;
+    }
 
-            ai.update(currentState, 0, reward, currentState, true);
+    // Picked once per run; from here on every rule set and algorithm has its own fully inlined hand loop
+    return dispatchRules(own.rules, [&](auto rules) {
+        using Rules = decltype(rules);
+        switch (own.algorithm) {
+        case LearnerAlgorithm::Sarsa: {
+            SarsaAgent agent{ai};
+            return trainSilent<Rules>(ai, agent, totalHands, own);
+        }
+        case LearnerAlgorithm::ExpectedSarsa: {
+            ExpectedSarsaAgent agent{ai};
+            return trainSilent<Rules>(ai, agent, totalHands, own);
+        }
+        case LearnerAlgorithm::DoubleQ: {
+            DoubleQAgent agent(ai);
+            return trainSilent<Rules>(ai, agent, totalHands, own);
+        }
+        case LearnerAlgorithm::MonteCarlo: {
+            MonteCarloAgent agent{ai};
+            return trainSilent<Rules>(ai, agent, totalHands, own);
         }
+        case LearnerAlgorithm::QLearning:
+            break;
+        }
+        QLearningAgent agent{ai};
+        return trainSilent<Rules>(ai, agent, totalHands, own);
+    });
+}
+
+TrainerStats runParallelTrainer(QLearner& ai, long long totalHands, const TrainerConfig& config) {
+    std::ostream& log = trainerLog(config);
+    if (config.algorithm != LearnerAlgorithm::QLearning) {
+        log << "Only Q-learning trains on several threads; training " << algorithmName(config.algorithm)
+                  << " on one." << std::endl;
+        return runSilentTrainer(ai, totalHands, config);
     }
-    std::cout << "Training complete. Q-Table size: " << ai.qTable.size() << " states." << std::endl;
-}
\ No newline at end of file
+    int threads = std::max(1, config.threads);
+    TrainerSync sync = config.sync;
+    if (sync == TrainerSync::Shared && (ai.epsilonSchedule.perState() || ai.alphaSchedule.perState())) {
+        log << "Visit-based schedules need per-thread visit counts; using shadow tables." << std::endl;
+        sync = TrainerSync::Shadow;
+    }
+    log << "Training AI for " << totalHands << " hands on " << threads << " threads ("
+              << (sync == TrainerSync::Shadow ? "shadow tables" : "shared table") << ")..." << std::endl;
+
+    if (config.replayCapacity > 0) log << "Experience replay only runs in the single-threaded trainer; ignored." << std::endl;
+    if (config.history) config.history->beginSession(HistorySource::Training, getMasterSeed(), config.decks, config.rules);
+    TrainingWindows windows(config, sync == TrainerSync::Shared ? threads : 1);
+    auto start = std::chrono::steady_clock::now();
+    long long played = 0;
+    if (sync == TrainerSync::Shadow) {
+        played = dispatchRules(config.rules, [&](auto rules) {
+            return trainShadow<decltype(rules)>(ai, totalHands, config, threads, windows);
+        });
+    } else {
+        AtomicQTable table;
+        table.loadFrom(ai.qTable);
+        played = dispatchRules(config.rules, [&](auto rules) {
+            return trainShared<decltype(rules)>(ai, table, totalHands, config, threads, 0, windows);
+        });
+        table.storeTo(ai.qTable);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    TrainerStats stats;
+    stats.hands = played;
+    stats.budget = totalHands;
+    stats.converged = windows.converged();
+    stats.seconds = elapsed.count();
+    stats.handsPerSecond = stats.seconds > 0 ? played / stats.seconds : 0;
+
+    log << "Training complete. Q-Table size: " << ai.qTable.size() << " states. "
+              << static_cast<long long>(stats.handsPerSecond) << " hands/sec." << std::endl;
+    reportStop(log, stats, windows);
+    return stats;
+}
+
+TrainerStats runSharedMemoryTrainer(QLearner& ai, long long totalHands, const TrainerConfig& config, SharedQTable& shared) {
+    std::ostream& log = trainerLog(config);
+    int threads = std::max(1, config.threads);
+    log << "Training AI for " << totalHands << " hands on " << threads << " thread(s) of process "
+              << shared.memberSlot() << " (" << shared.members() << " attached)..." << std::endl;
+    if (config.replayCapacity > 0) log << "Experience replay only runs in the single-threaded trainer; ignored." << std::endl;
+    if (config.history) config.history->beginSession(HistorySource::Training, getMasterSeed(), config.decks, config.rules);
+
+    // Only the current leader checkpoints, so the database sees one writer however many processes train
+    TrainingWindows windows(config, threads);
+    auto start = std::chrono::steady_clock::now();
+    long long played = dispatchRules(config.rules, [&](auto rules) {
+        return trainShared<decltype(rules)>(ai, shared.table(), totalHands, config, threads,
+                                            shared.memberSlot() * threads, windows, &shared);
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    shared.addHands(played);
+    shared.table().storeTo(ai.qTable);
+
+    TrainerStats stats;
+    stats.hands = played;
+    stats.budget = totalHands;
+    stats.converged = windows.converged();
+    stats.seconds = elapsed.count();
+    stats.handsPerSecond = stats.seconds > 0 ? played / stats.seconds : 0;
+
+    log << "Training complete. Q-Table size: " << ai.qTable.size() << " states. "
+              << static_cast<long long>(stats.handsPerSecond) << " hands/sec, " << shared.handsTrained()
+              << " hands trained on the shared table so far." << std::endl;
+    reportStop(log, stats, windows);
+    return stats;
+}
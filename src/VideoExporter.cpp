@@ -0,0 +1,158 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "BoundedQueue.h"
+#include "Hand.h"
+#include "Random.h"
+#include "Renderer.h"
+#include "Shoe.h"
+#include "VideoExporter.h"
+
+namespace {
+
+// One table state, recorded at the same points playRound draws to the GUI
+struct TableSnapshot {
+    Hand player;
+    Hand dealer;
+    const char* message = "";
+    const char* result = nullptr; // Set on the end-of-hand snapshot
+    bool dealersTurn = false;
+    int hand = 0;
+};
+
+struct Frame {
+    cv::Mat image;
+    int repeats = 1;
+};
+
+int greedyAction(const QTable& policy, const State& s) {
+    const double* q = policy.at(s);
+    return (q[1] > q[0]) ? 1 : 0;
+}
+
+// Same rules and decision points as playRound in AI mode, minus the console output
+void simulate(const QTable& policy, const VideoConfig& config, BoundedQueue<TableSnapshot>& snapshots) {
+    Shoe shoe(config.decks, config.penetration, false, streamRng(STREAM_VIDEO_SHOE));
+    for (int h = 1; h <= config.hands; ++h) {
+        shoe.prepareRound();
+        TableSnapshot snap;
+        snap.hand = h;
+
+        // Initial Deal
+        snap.player.addCard(shoe.dealCard());
+        snap.dealer.addCard(shoe.dealCard());
+        snap.player.addCard(shoe.dealCard());
+        snap.dealer.addCard(shoe.dealCard());
+
+        auto record = [&](const char* message, bool dealersTurn, const char* result = nullptr) {
+            snap.message = message;
+            snap.dealersTurn = dealersTurn;
+            snap.result = result;
+            return snapshots.push(snap);
+        };
+
+        if (snap.player.getTotal() == 21) {
+            if (!record("BLACKJACK!", false) || !record("BLACKJACK!", false, "BLACKJACK!")) return;
+            continue;
+        }
+
+        // Player Turn
+        while (!snap.player.isBust()) {
+            if (!record("Player's Turn", false)) return;
+            State s = {snap.player.getTotal(), snap.dealer.getCard(0).getValue(), false};
+            if (greedyAction(policy, s) == 0) break;
+            snap.player.addCard(shoe.dealCard());
+        }
+
+        if (snap.player.isBust()) {
+            if (!record("Player BUSTS!", false) || !record("Player BUSTS!", false, "DEALER WINS!")) return;
+            continue;
+        }
+
+        // Dealer Turn (Must hit until 17)
+        while (snap.dealer.getTotal() < 17) {
+            snap.dealer.addCard(shoe.dealCard());
+            if (!record("Dealer's Turn", true)) return;
+        }
+        if (!record("Dealer's Turn", true)) return;
+
+        int pTotal = snap.player.getTotal();
+        int dTotal = snap.dealer.getTotal();
+        const char* result = "IT'S A PUSH (TIE)!";
+        if (dTotal > 21 || pTotal > dTotal) result = "YOU WIN!";
+        else if (pTotal < dTotal) result = "DEALER WINS!";
+        if (!record("Dealer's Turn", true, result)) return;
+    }
+}
+
+void compose(Renderer& renderer, const VideoConfig& config, BoundedQueue<TableSnapshot>& snapshots,
+             BoundedQueue<cv::Mat>& pool, BoundedQueue<Frame>& frames, long long& composed) {
+    TableSnapshot snap;
+    while (snapshots.pop(snap)) {
+        if (snap.result) {
+            std::string label = "Hand " + std::to_string(snap.hand) + " of " + std::to_string(config.hands);
+            renderer.displayPrompt(snap.player, snap.dealer, label, snap.result);
+        } else {
+            renderer.displayState(snap.player, snap.dealer, snap.message, snap.dealersTurn);
+        }
+
+        Frame frame;
+        if (!pool.pop(frame.image)) break;
+        renderer.getFrame().copyTo(frame.image);
+        frame.repeats = snap.result ? config.framesPerResult : config.framesPerState;
+        if (!frames.push(std::move(frame))) break;
+        ++composed;
+    }
+    frames.close();
+}
+
+void encode(cv::VideoWriter& writer, BoundedQueue<Frame>& frames, BoundedQueue<cv::Mat>& pool, long long& written) {
+    Frame frame;
+    while (frames.pop(frame)) {
+        for (int r = 0; r < frame.repeats; ++r) writer.write(frame.image);
+        written += frame.repeats;
+        pool.push(std::move(frame.image));
+    }
+}
+
+} // namespace
+
+VideoStats exportVideo(const QTable& policy, const VideoConfig& config) {
+    VideoStats stats;
+
+    // Built here so card loading is not counted as encoding time
+    Renderer renderer(0, true);
+    cv::Size frameSize = renderer.getFrame().size();
+
+    cv::VideoWriter writer;
+    if (!writer.open(config.file, config.fourcc, config.fps, frameSize, true) || !writer.isOpened()) {
+        std::cerr << "Could not open " << config.file << " for writing (is the codec available?)" << std::endl;
+        return stats;
+    }
+
+    BoundedQueue<TableSnapshot> snapshots(config.snapshotQueue);
+    BoundedQueue<Frame> frames(config.frameQueue);
+    BoundedQueue<cv::Mat> pool(config.frameQueue);
+    for (size_t i = 0; i < config.frameQueue; ++i) {
+        pool.push(cv::Mat(frameSize, renderer.getFrame().type()));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread simulation([&]() {
+        simulate(policy, config, snapshots);
+        snapshots.close();
+    });
+    std::thread composition([&]() { compose(renderer, config, snapshots, pool, frames, stats.composed); });
+    encode(writer, frames, pool, stats.frames);
+    simulation.join();
+    composition.join();
+    writer.release();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    stats.hands = config.hands;
+    stats.seconds = elapsed.count();
+    stats.framesPerSecond = stats.seconds > 0 ? stats.frames / stats.seconds : 0;
+    stats.simulationStalls = snapshots.getFullWaits();
+    stats.composeStalls = pool.getEmptyWaits();
+    return stats;
+}
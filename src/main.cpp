@@ -10,12 +10,62 @@
  *             - argv[1]: trainMode (0 = Train new model, 1 = Load existing model)
  *             - argv[2]: playMode (0 = Manual player, 1 = AI player)
  *             - argv[3]: guiMode (0 = Console output, 1 = GUI rendering with OpenCV)
+ *             - --threads N: train on N worker threads
+ *             - --sync shadow|shared: how worker threads combine their Q-tables
+ *             - --decks N: decks in the shoe (default 6)
+ *             - --penetration P: fraction of the shoe dealt before reshuffling (default 0.75)
+ *             - --rules NAME|FILE: house rules for training, play and --eval: a preset (classic, strip,
+ *               downtown, six-five, european) or a file of key = value lines; --decks/--penetration override it.
+ *               --grade, --algorithms, --seats-compare, --count, --tiles and --record refuse any but classic
+ *             - --seed S: master RNG seed; the same seed repeats a run exactly
+ *             - --grade: print the exact EV of every state and of the whole saved policy, then exit
+ *             - --eval N: play N hands of the saved policy headlessly (spread over --threads) and report EV
+ *             - --json FILE: with --eval, write the results as JSON to FILE ("-" for stdout, which then
+ *               carries only the JSON while everything else goes to stderr)
+ *             - --table FILE: play, grade or evaluate a binary Q-table mapped from FILE instead of the database
+ *             - --fps N: GUI frame rate (default 2); in AI mode rounds also continue on their own
+ *             - --checkpoint N: save a snapshot in the background every N training hands (0 = only at the end)
+ *             - --shm NAME: train on the POSIX shared-memory Q-table NAME together with every other process
+ *               attached to it (created by the first, empty with trainMode 0 or from the database with 1);
+ *               the current leader checkpoints and the last process to finish saves the table and removes the segment
+ *             - --history FILE: append every training and played hand to a binary hand-history log
+ *             - --telemetry FILE: write training metrics every --telemetry-every N hands (default 10000)
+ *               as CSV, or as JSON lines if FILE ends in .json/.jsonl ("-" for CSV on stdout, which then
+ *               carries only the CSV while everything else goes to stderr)
+ *             - --hands N: hands to train (default 250000); with early stopping, the most to train
+ *             - --epsilon SPEC, --alpha SPEC: exploration and learning-rate schedules, either a number
+ *               or linear:START:END:HANDS, exp:START:END:HALF_LIFE or visits:START:END:SCALE
+ *             - --algorithm NAME: learn with q (default), sarsa, expected-sarsa, double-q or monte-carlo
+ *             - --algorithms N: train every algorithm for N hands, print hands/sec and exact EV of each, then exit
+ *             - --seats SPEC: train at a table of up to 7 seats sharing one shoe and dealer, e.g.
+ *               learner,learner,fixed:17,policy,recorded:hands.bjh; --hands counts learner episodes
+ *             - --seats-compare N: train N episodes on the single-seat trainer and at tables of 1-7 learner
+ *               seats, print episodes/sec and exact EV of each, then exit
+ *             - --stop-stable N: stop once the greedy policy has not changed (beyond --stop-tolerance F,
+ *               a fraction of the known states) for N checks running
+ *             - --stop-dq X: stop once the mean |dQ| per update over a check window is below X
+ *             - --stop-every N: hands between convergence checks (default 10000)
+ *             - --replay N: keep the last N transitions and replay batches of them while training
+ *             - --replay-batch N, --replay-ratio N: batch size and batches replayed per hand (default 32, 1)
+ *             - --replay-rate R: learning rate for replayed transitions (default 0.005)
+ *             - --prioritized: sample replayed transitions by TD error instead of uniformly
+ *             - --learn-from FILE: learn offline from a hand-history log into the database, then exit
+ *             - --count N: train count-aware and count-blind learners for N hands each on a persistent
+ *               shoe, evaluate both (--eval hands, default 1e7) and print EV by true count, then exit
+ *             - --tiles N: train the tile-coding learner and the tabular count-aware learner at doubling hand
+ *               counts up to N, print memory and EV (--eval hands, default 2e6) of each, save the tile
+ *               weights to the database and exit; with trainMode 1, evaluate the saved weights instead
+ *             - --tile-bits B: the tile coder hashes into 2^B cells (default 12)
+ *             - --record FILE: render the saved policy playing --record-hands N hands (default 1000)
+ *               offscreen into a video file, then exit (GUI build only)
  * 
  * @return int EXIT_SUCCESS (0) on successful completion, or non-zero on error.
  * 
  * @details
  *   - Initializes the QLearner AI with a SQLite database for Q-value persistence.
- *   - Trains the AI using silent training (250,000 iterations) if no database exists.
+ *     Training saves changed states incrementally, with periodic background checkpoints.
+ *   - Trains the AI using silent training (250,000 iterations, or until the policy converges
+ *     with early stopping on) if no database exists.
  *   - Supports three combinations of play modes:
  *     - Manual + Console: Player makes decisions via keyboard input.
  *     - Manual + GUI: Player makes decisions via GUI interface.
@@ -23,64 +73,114 @@
  *   - Runs an interactive game loop allowing multiple rounds until user exits.
  * 
  * @note Requires environment setup with SQLite3 library and OpenCV (if GUI mode enabled).
+ * @note Built twice: BlackjackAI defines BLACKJACK_GUI and links the OpenCV Renderer;
+ *       BlackjackCLI leaves it out and falls back to the console when guiMode is 1.
  * @note Database file "blackjack_brain.db" is created/loaded from the current working directory.
  * @note Memory for GUI renderer is dynamically allocated and freed upon program exit.
  */
 #include <iostream>
 #include <vector>
 #include <string>
+#include <memory>
 #include <algorithm>
 #include <random>
 #include <chrono>
+#include <fstream>
+#include <stdexcept>
 #include <sqlite3.h>
 #include "Card.h"
-#include "Deck.h"
+#include "Shoe.h"
 #include "Hand.h"
 #include "QLearner.h"
+#include "QTableStore.h"
+#include "QTableFile.h"
+#include "SharedQTable.h"
+#include "TableSimulator.h"
 #include "Trainer.h"
+#include "LearnerAlgorithms.h"
+#include "PolicyGrader.h"
+#include "Evaluator.h"
+#include "HandHistory.h"
+#include "Telemetry.h"
+#include "ReplayBuffer.h"
+#include "CountLearner.h"
+#include "TileLearner.h"
+#include "Random.h"
+
+#ifdef BLACKJACK_GUI
 #include "Renderer.h"
-#include <opencv2/opencv.hpp>
+#include "VideoExporter.h"
+#else
+// Headless build: no Renderer is ever created, so gui is always nullptr.
+// This empty stand-in lets playRound compile without OpenCV.
+class Renderer {
+public:
+    void displayState(const Hand&, const Hand&, const std::string&, bool = false) {}
+    void displayPrompt(const Hand&, const Hand&, const std::string&, const std::string& = "") {}
+    int displayActionPrompt(const Hand&, const Hand&, const std::string&) { return 0; }
+    int getKeyPressed() const { return -1; }
+    void resetKeyPressed() {}
+};
+#endif
 
 /**
  * @brief Executes a single round of blackjack with AI player and optional GUI rendering.
  * 
  * @param ai A reference to the QLearner object that controls the AI player's decisions
  *           based on learned Q-values from previous training.
+ * @param shoe The multi-deck shoe shared by every round of the session. It is
+ *             reshuffled at the start of a round once the cut card has come out.
  * @param playMode An integer flag determining the game mode (e.g., training, testing,
  *                  or interactive play).
  * @param gui A pointer to the Renderer object used for displaying game state, cards,
  *            and results. If nullptr, the round may proceed without visual output.
+ * @param history Hand-history log that receives the finished hand, or nullptr.
+ * @tparam Rules The house rules (HouseRules<...>), picked once per round by dispatchRules.
  * 
  * @return void
  * 
  * @note Modifies the state of the QLearner object during the round.
  * @note gui may be nullptr for headless execution.
  */
-void playRound(QLearner& ai, int playMode, Renderer* gui) {
+template <typename Rules>
+void playRound(QLearner& ai, Shoe& shoe, int playMode, Renderer* gui, HandHistoryWriter* history) {
     std::cout << "Starting a new round of Blackjack..." << std::endl;
 
-    Deck deck;
-    deck.shuffle();
+    bool reshuffled = shoe.prepareRound();
+    if (reshuffled) {
+        std::cout << "Cut card reached - shuffling the shoe." << std::endl;
+    }
     
     Hand playerHand;
     Hand dealerHand;
 
     // Initial Deal
-    playerHand.addCard(deck.dealCard());
-    dealerHand.addCard(deck.dealCard());
-    playerHand.addCard(deck.dealCard());
-    dealerHand.addCard(deck.dealCard());
+    playerHand.addCard(shoe.dealCard());
+    dealerHand.addCard(shoe.dealCard());
+    playerHand.addCard(shoe.dealCard());
+    dealerHand.addCard(shoe.dealCard());
 
     std::cout << "\n--- New Round ---" << std::endl;
     std::cout << "Dealer shows: " << dealerHand.getCard(0).toString() << " [Hidden]" << std::endl;
 
-    // Check for player blackjack (21 with first 2 cards)
-    if (playerHand.getSize() == 2 && playerHand.getTotal() == 21) {
-        std::cout << "BLACKJACK! Player wins!" << std::endl;
+    // Check for blackjack (21 with the first 2 cards): the player's, and with peek the dealer's
+    HandOutcome opening;
+    double payout;
+    if (Rules::settleDeal(playerHand, dealerHand, opening, payout)) {
+        std::string result;
+        if (opening == HandOutcome::Blackjack) {
+            std::cout << "BLACKJACK! Player wins! (pays " << payout << " to 1)" << std::endl;
+            result = "BLACKJACK!";
+        } else {
+            std::cout << "Dealer peeks: " << dealerHand.getCard(1).toString() << ". Dealer has blackjack!" << std::endl;
+            result = opening == HandOutcome::Push ? "IT'S A PUSH (TIE)!" : "DEALER WINS!";
+            std::cout << result << std::endl;
+        }
+        if (history) history->record(playerHand, dealerHand, opening, reshuffled);
         
         if (gui) {
-            gui->displayState(playerHand, dealerHand, "BLACKJACK!", false);
-            gui->displayPrompt(playerHand, dealerHand, "Play another round? (Y/N)", "BLACKJACK!");
+            gui->displayState(playerHand, dealerHand, result, opening != HandOutcome::Blackjack);
+            gui->displayPrompt(playerHand, dealerHand, "Play another round? (Y/N)", result);
         }
         return;
     }
@@ -102,7 +202,7 @@ void playRound(QLearner& ai, int playMode, Renderer* gui) {
                 std::cout << (action == 1 ? "Player chose: HIT" : "Player chose: STAND") << std::endl;
             } else {
                 std::cout << "(h)it or (s)tand? ";
-                char choice; 
+                char choice = 's'; // End of input stands
                 std::cin >> choice;
                 action = (choice == 'h' || choice == 'H') ? 1 : 0;
             }
@@ -114,7 +214,7 @@ void playRound(QLearner& ai, int playMode, Renderer* gui) {
         }
 
         if (action == 1) {
-            playerHand.addCard(deck.dealCard());
+            playerHand.addCard(shoe.dealCard());
             std::cout << "Drew: " << playerHand.getCard(playerHand.getSize() - 1).toString() << std::endl;
         } else {
             break;
@@ -124,6 +224,7 @@ void playRound(QLearner& ai, int playMode, Renderer* gui) {
     // Check for player bust
     if (playerHand.isBust()) {
         std::cout << "Player busts with total: " << playerHand.getTotal() << std::endl;
+        if (history) history->record(playerHand, dealerHand, HandOutcome::Loss, reshuffled);
         
         if (gui) {
             gui->displayState(playerHand, dealerHand, "Player BUSTS!", false);
@@ -132,10 +233,10 @@ void playRound(QLearner& ai, int playMode, Renderer* gui) {
         return;
     }
 
-    // Dealer Turn (Must hit until 17)
+    // Dealer Turn (hits below 17, and on soft 17 under H17 rules)
     std::cout << "\nDealer reveals: " << dealerHand.getCard(1).toString() << std::endl;
-    while (dealerHand.getTotal() < 17) {
-        dealerHand.addCard(deck.dealCard());
+    while (Rules::dealerDraws(dealerHand)) {
+        dealerHand.addCard(shoe.dealCard());
         std::cout << "Dealer hits: " << dealerHand.getCard(dealerHand.getSize() - 1).toString() << std::endl;
 
         if (gui) {
@@ -167,6 +268,7 @@ void playRound(QLearner& ai, int playMode, Renderer* gui) {
     }
     
     std::cout << "Round finished." << std::endl;
+    if (history) history->record(playerHand, dealerHand, settleHand(playerHand, dealerHand), reshuffled);
 
     // Display result with prompt
     if (gui) {
@@ -174,11 +276,31 @@ void playRound(QLearner& ai, int playMode, Renderer* gui) {
     }
 }
 
-int main(int argc, char* argv[]) {
-    std::cout << "--- Blackjack AI Initializing ---" << std::endl;
-    std::cout << "SQLite Version: " << sqlite3_libversion() << std::endl;
-    std::cout << "Environment check passed!" << std::endl;
+/**
+ * @brief Parses the value of a hand-count flag such as --hands or --eval.
+ *
+ * @param flag The flag, for the error message.
+ * @param text The value as given; scientific notation (1e6) is accepted.
+ * @param hands Receives the count.
+ *
+ * @return true for a whole number of hands from 1 to 1e18; otherwise prints why on std::cerr and returns false.
+ */
+bool parseHandCount(const std::string& flag, const std::string& text, long long& hands) {
+    double value = 0;
+    try {
+        value = std::stod(text);
+    } catch (const std::exception&) {
+        value = 0;
+    }
+    if (!(value >= 1 && value <= 1e18)) {
+        std::cerr << flag << " needs a positive number of hands (at most 1e18), got \"" << text << "\"" << std::endl;
+        return false;
+    }
+    hands = static_cast<long long>(value);
+    return true;
+}
 
+int main(int argc, char* argv[]) {
     QLearner myAI;
     std::string dbFile = "blackjack_brain.db";
 
@@ -186,35 +308,483 @@ int main(int argc, char* argv[]) {
     int trainMode = 0;  // 0 = Train, 1 = Load
     int playMode = 0;   // 0 = Manual, 1 = AI
     int guiMode = 0;    // 0 = Console, 1 = GUI
+    TrainerConfig trainerConfig;
+    bool gradeMode = false; // --grade: score the saved policy exactly and exit
+    long long evalHands = 0; // --eval N: simulate N hands of the saved policy and exit
+    std::string jsonFile;
+    std::string tableFile;   // --table: binary Q-table used in place of the database
+    // --fps: 0 keeps the default 500ms frames and waits for keys between rounds (read by the GUI build only)
+    [[maybe_unused]] int guiFps = 0;
+    std::string recordFile;  // --record: write a video of the saved policy and exit
+    [[maybe_unused]] int recordHands = 1000; // --record-hands (GUI build only)
+    std::string historyFile; // --history: log every hand trained and played
+    std::string telemetryFile; // --telemetry: periodic training metrics
+    long long trainHands = 250000; // --hands: the training budget
+    long long compareHands = 0;    // --algorithms: train and compare every learner algorithm, then exit
+    std::string learnFile;   // --learn-from: offline learning from a hand-history log
+    long long countHands = 0; // --count: train and compare count-aware play, then exit
+    long long tileHands = 0;  // --tiles: compare tile coding with the count-aware table, then exit
+    int tileBits = 12;
+    std::string shmName;      // --shm: train on a shared-memory table with other processes
+    std::string seatSpec;     // --seats: train at a multi-seat table
+    long long seatCompareEpisodes = 0; // --seats-compare: single seat against 1-7 seats, then exit
+    std::string rulesSpec;    // --rules: a rule preset or rules file
+    bool decksGiven = false, penetrationGiven = false; // ...which these override
 
-    if (argc > 1) trainMode = std::stoi(argv[1]);
-    if (argc > 2) playMode = std::stoi(argv[2]);
-    if (argc > 3) guiMode = std::stoi(argv[3]);
+    // Flags may appear anywhere; everything else is a positional mode argument
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            trainerConfig.threads = std::stoi(argv[++i]);
+        } else if (arg == "--sync" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            trainerConfig.sync = (mode == "shared") ? TrainerSync::Shared : TrainerSync::Shadow;
+        } else if (arg == "--decks" && i + 1 < argc) {
+            trainerConfig.decks = std::stoi(argv[++i]);
+            decksGiven = true;
+        } else if (arg == "--penetration" && i + 1 < argc) {
+            trainerConfig.penetration = std::stod(argv[++i]);
+            penetrationGiven = true;
+        } else if (arg == "--rules" && i + 1 < argc) {
+            rulesSpec = argv[++i];
+        } else if (arg == "--grade") {
+            gradeMode = true;
+        } else if (arg == "--eval" && i + 1 < argc) {
+            if (!parseHandCount(arg, argv[++i], evalHands)) return EXIT_FAILURE; // Accepts 1e7
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            trainerConfig.checkpointInterval = std::stoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            guiFps = std::stoi(argv[++i]);
+        } else if (arg == "--table" && i + 1 < argc) {
+            tableFile = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (arg == "--record-hands" && i + 1 < argc) {
+            recordHands = std::stoi(argv[++i]);
+        } else if (arg == "--replay" && i + 1 < argc) {
+            trainerConfig.replayCapacity = std::stoi(argv[++i]);
+        } else if (arg == "--replay-batch" && i + 1 < argc) {
+            trainerConfig.replayBatchSize = std::stoi(argv[++i]);
+        } else if (arg == "--replay-ratio" && i + 1 < argc) {
+            trainerConfig.replayBatches = std::stoi(argv[++i]);
+        } else if (arg == "--replay-rate" && i + 1 < argc) {
+            trainerConfig.replayRate = std::stod(argv[++i]);
+        } else if (arg == "--prioritized") {
+            trainerConfig.replayPrioritized = true;
+        } else if (arg == "--count" && i + 1 < argc) {
+            if (!parseHandCount(arg, argv[++i], countHands)) return EXIT_FAILURE;
+        } else if (arg == "--tiles" && i + 1 < argc) {
+            if (!parseHandCount(arg, argv[++i], tileHands)) return EXIT_FAILURE;
+        } else if (arg == "--tile-bits" && i + 1 < argc) {
+            tileBits = std::stoi(argv[++i]);
+        } else if (arg == "--learn-from" && i + 1 < argc) {
+            learnFile = argv[++i];
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shmName = argv[++i];
+        } else if (arg == "--history" && i + 1 < argc) {
+            historyFile = argv[++i];
+        } else if (arg == "--telemetry" && i + 1 < argc) {
+            telemetryFile = argv[++i];
+        } else if (arg == "--telemetry-every" && i + 1 < argc) {
+            trainerConfig.telemetryInterval = std::stoi(argv[++i]);
+        } else if (arg == "--hands" && i + 1 < argc) {
+            if (!parseHandCount(arg, argv[++i], trainHands)) return EXIT_FAILURE; // Accepts 1e6
+        } else if ((arg == "--epsilon" || arg == "--alpha") && i + 1 < argc) {
+            Schedule schedule;
+            if (!Schedule::parse(argv[++i], schedule)) return EXIT_FAILURE;
+            bool epsilon = arg == "--epsilon";
+            if (schedule.kind == ScheduleKind::Constant) {
+                (epsilon ? myAI.epsilon : myAI.alpha) = schedule.start;
+            } else {
+                (epsilon ? myAI.epsilonSchedule : myAI.alphaSchedule) = schedule;
+            }
+        } else if (arg == "--algorithm" && i + 1 < argc) {
+            if (!parseAlgorithm(argv[++i], trainerConfig.algorithm)) return EXIT_FAILURE;
+        } else if (arg == "--algorithms" && i + 1 < argc) {
+            if (!parseHandCount(arg, argv[++i], compareHands)) return EXIT_FAILURE;
+        } else if (arg == "--seats" && i + 1 < argc) {
+            seatSpec = argv[++i];
+        } else if (arg == "--seats-compare" && i + 1 < argc) {
+            if (!parseHandCount(arg, argv[++i], seatCompareEpisodes)) return EXIT_FAILURE;
+        } else if (arg == "--stop-stable" && i + 1 < argc) {
+            trainerConfig.stopPatience = std::stoi(argv[++i]);
+        } else if (arg == "--stop-tolerance" && i + 1 < argc) {
+            trainerConfig.stopPolicyTolerance = std::stod(argv[++i]);
+        } else if (arg == "--stop-dq" && i + 1 < argc) {
+            trainerConfig.stopDeltaQ = std::stod(argv[++i]);
+        } else if (arg == "--stop-every" && i + 1 < argc) {
+            trainerConfig.stopCheckInterval = std::stoi(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            setMasterSeed(std::stoull(argv[++i]));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    // With --json - or --telemetry -, stdout carries that document alone; everything else goes to stderr
+    if (jsonFile == "-" && telemetryFile == "-") {
+        std::cerr << "--json - and --telemetry - cannot both write to stdout." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::ostream jsonOut(std::cout.rdbuf());
+    if (jsonFile == "-" || telemetryFile == "-") std::cout.rdbuf(std::cerr.rdbuf());
+
+    std::cout << "--- Blackjack AI Initializing ---" << std::endl;
+    std::cout << "SQLite Version: " << sqlite3_libversion() << std::endl;
+    std::cout << "Environment check passed!" << std::endl;
+
+    if (positional.size() > 0) trainMode = std::stoi(positional[0]);
+    if (positional.size() > 1) playMode = std::stoi(positional[1]);
+    if (positional.size() > 2) guiMode = std::stoi(positional[2]);
+
+    // Always shown so any run can be repeated exactly with --seed
+    std::cout << "Seed: " << getMasterSeed() << std::endl;
+
+    if (!rulesSpec.empty()) {
+        if (!RuleSet::resolve(rulesSpec, trainerConfig.rules)) return EXIT_FAILURE;
+        if (!decksGiven) trainerConfig.decks = trainerConfig.rules.decks;
+        if (!penetrationGiven) trainerConfig.penetration = trainerConfig.rules.penetration;
+        trainerConfig.rules.decks = trainerConfig.decks;
+        trainerConfig.rules.penetration = trainerConfig.penetration;
+        std::cout << "Rules: " << trainerConfig.rules.describe() << std::endl;
+    }
+
+    // These modes grade or play under the classic rules only, so other rules would be
+    // printed above results that ignore them
+    const char* classicOnly = countHands > 0 ? "--count"
+                            : compareHands > 0 ? "--algorithms"
+                            : seatCompareEpisodes > 0 ? "--seats-compare"
+                            : gradeMode ? "--grade"
+                            : !recordFile.empty() ? "--record"
+                            : tileHands > 0 ? "--tiles"
+                            : nullptr;
+    if (classicOnly && !trainerConfig.rules.isClassic()) {
+        std::cerr << classicOnly << " grades and plays the classic rules only; it cannot use --rules "
+                  << trainerConfig.rules.name << " (--decks and --penetration still apply)." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (countHands > 0) {
+        std::cout << "--- [MODE: COUNT-AWARE TRAINING, " << trainerConfig.decks << " DECKS] ---" << std::endl;
+        // Both tables are 135KB; keep them off the stack
+        std::unique_ptr<CountLearner> aware(new CountLearner());
+        std::unique_ptr<CountLearner> blind(new CountLearner());
+        blind->useCount = false;
+        runCountTrainer(*aware, countHands, trainerConfig);
+        runCountTrainer(*blind, countHands, trainerConfig);
+
+        long long hands = evalHands > 0 ? evalHands : 10000000;
+        CountEvalResult awareResult = evaluateCountPolicy(aware->qTable, true, hands, trainerConfig.decks,
+                                                          trainerConfig.penetration, trainerConfig.threads);
+        CountEvalResult blindResult = evaluateCountPolicy(blind->qTable, false, hands, trainerConfig.decks,
+                                                          trainerConfig.penetration, trainerConfig.threads);
+        printCountComparison(std::cout, awareResult, blindResult, aware->qTable);
+        return EXIT_SUCCESS;
+    }
+
+    if (compareHands > 0) {
+        std::cout << "--- [MODE: COMPARING LEARNER ALGORITHMS] ---" << std::endl;
+        compareLearnerAlgorithms(std::cout, myAI, compareHands, trainerConfig);
+        return EXIT_SUCCESS;
+    }
+
+    if (seatCompareEpisodes > 0) {
+        std::cout << "--- [MODE: COMPARING TABLE SEATS] ---" << std::endl;
+        compareTableSeats(std::cout, myAI, seatCompareEpisodes, trainerConfig);
+        return EXIT_SUCCESS;
+    }
+
+    // Like --count, ahead of --eval, which here only sizes the evaluation
+    if (tileHands > 0) {
+        QTableStore store(dbFile);
+        std::cout << "--- [MODE: TILE CODING VS. TABLE, " << trainerConfig.decks << " DECKS] ---" << std::endl;
+        long long hands = evalHands > 0 ? evalHands : 2000000;
+        TileLearner tiles(tileBits);
+        if (trainMode == 1 && tiles.load(store)) {
+            std::unique_ptr<CountQTable> policy(new CountQTable());
+            tiles.exportPolicy(*policy);
+            CountEvalResult result = evaluateCountPolicy(*policy, true, hands, trainerConfig.decks,
+                                                         trainerConfig.penetration, trainerConfig.threads);
+            std::cout << "Saved tile weights: EV " << result.ev << " +/- " << result.stdError << " over "
+                      << result.hands << " hands" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        compareTileLearner(std::cout, tileHands, 5, hands, tileBits, trainerConfig, &tiles);
+        if (!tiles.save(store)) return EXIT_FAILURE;
+        std::cout << "Tile weights saved to " << dbFile << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // A --table file is used straight from its mapping; the database is parsed into myAI
+    std::unique_ptr<MappedQTable> mappedTable;
+    const QTable* policy = &myAI.qTable;
+    std::string policySource = tableFile.empty() ? dbFile : tableFile;
+    if (!tableFile.empty()) {
+        mappedTable.reset(new MappedQTable(tableFile));
+        if (!mappedTable->isOpen()) return EXIT_FAILURE;
+        policy = &mappedTable->table();
+        std::cout << "AI knowledge mapped from " << tableFile << ". States known: " << policy->size() << std::endl;
+    } else if (gradeMode || evalHands > 0 || !recordFile.empty()) {
+        myAI.loadFromDatabase(dbFile);
+    }
+
+    if (gradeMode) {
+        std::cout << "--- [MODE: GRADING " << policySource << "] ---" << std::endl;
+        if (policy->empty()) {
+            std::cerr << "No trained policy in " << policySource << " to grade." << std::endl;
+            return EXIT_FAILURE;
+        }
+        printPolicyGrade(std::cout, gradePolicy(*policy));
+        printPolicyGrade(std::cout, gradePolicy(*policy, trainerConfig.decks), false);
+        return EXIT_SUCCESS;
+    }
+
+    if (evalHands > 0) {
+        std::cout << "--- [MODE: EVALUATING " << policySource << "] ---" << std::endl;
+        if (policy->empty()) {
+            std::cerr << "No trained policy in " << policySource << " to evaluate." << std::endl;
+            return EXIT_FAILURE;
+        }
+        EvalResult result = evaluatePolicy(*policy, evalHands, trainerConfig.threads, trainerConfig.rules);
+        printEvalResult(std::cout, result);
+
+        if (jsonFile == "-") {
+            writeEvalJson(jsonOut, result);
+        } else if (!jsonFile.empty()) {
+            std::ofstream json(jsonFile);
+            if (!json) {
+                std::cerr << "Could not write " << jsonFile << std::endl;
+                return EXIT_FAILURE;
+            }
+            writeEvalJson(json, result);
+            std::cout << "Results written to " << jsonFile << std::endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (!recordFile.empty()) {
+#ifdef BLACKJACK_GUI
+        std::cout << "--- [MODE: RECORDING " << policySource << " TO " << recordFile << "] ---" << std::endl;
+        if (policy->empty()) {
+            std::cerr << "No trained policy in " << policySource << " to record." << std::endl;
+            return EXIT_FAILURE;
+        }
+        VideoConfig video;
+        video.file = recordFile;
+        video.hands = recordHands;
+        video.decks = trainerConfig.decks;
+        video.penetration = trainerConfig.penetration;
+        if (guiFps > 0) video.fps = guiFps;
+        VideoStats stats = exportVideo(*policy, video);
+        if (stats.frames == 0) return EXIT_FAILURE;
+        std::cout << "Recorded " << stats.hands << " hands: " << stats.frames << " frames (" << stats.composed
+                  << " drawn) in " << stats.seconds << "s, " << stats.framesPerSecond << " frames/s" << std::endl;
+        std::cout << "Pipeline stalls: simulation " << stats.simulationStalls << ", composition "
+                  << stats.composeStalls << std::endl;
+        return EXIT_SUCCESS;
+#else
+        std::cerr << "This build has no video export (use BlackjackAI, built with OpenCV)." << std::endl;
+        return EXIT_FAILURE;
+#endif
+    }
+
+    // One connection for the whole session, shared by the checkpoint writer and the final save
+    QTableStore store(dbFile);
+
+    if (!learnFile.empty()) {
+        std::cout << "--- [MODE: LEARNING FROM " << learnFile << "] ---" << std::endl;
+        HandHistoryReader reader(learnFile);
+        if (!reader.isOpen()) return EXIT_FAILURE;
+        if (store.load(myAI.qTable) && !myAI.qTable.empty()) {
+            std::cout << "Continuing from " << dbFile << ". States known: " << myAI.qTable.size() << std::endl;
+        }
+        std::unique_ptr<ReplayBuffer> buffer;
+        if (trainerConfig.replayCapacity > 0) {
+            buffer.reset(new ReplayBuffer(trainerConfig.replayCapacity, trainerConfig.replayPrioritized
+                                                                            ? ReplaySampling::Prioritized
+                                                                            : ReplaySampling::Uniform));
+        }
+        HistoryReplayStats stats = learnFromHistory(myAI, reader, buffer.get(), trainerConfig.replayBatchSize,
+                                                    trainerConfig.replayBatches, trainerConfig.replayRate);
+        std::cout << "Learned from " << stats.hands << " hands (" << stats.transitions << " transitions, "
+                  << stats.batches << " replayed batches)." << std::endl;
+        if (reader.isTruncated()) std::cerr << "Warning: " << learnFile << " ends in a torn record" << std::endl;
+        if (!store.saveDirty(myAI.qTable)) return EXIT_FAILURE;
+        std::cout << "AI knowledge saved to " << dbFile << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<HandHistoryWriter> history;
+    if (!historyFile.empty()) {
+        history.reset(new HandHistoryWriter(historyFile));
+        if (!history->isOpen()) return EXIT_FAILURE;
+        trainerConfig.history = history.get();
+    }
+    std::unique_ptr<TelemetryWriter> telemetry;
+    if (!telemetryFile.empty()) {
+        telemetry.reset(new TelemetryWriter(telemetryFile));
+        if (!telemetry->isOpen()) return EXIT_FAILURE;
+        trainerConfig.telemetry = telemetry.get();
+    }
+
+    // Parsed before training replaces the database, so a "policy" seat plays the table saved last
+    std::vector<Seat> seats;
+    QTable seatPolicy;
+    if (!seatSpec.empty()) {
+        if (seatSpec.find("policy") != std::string::npos) store.load(seatPolicy);
+        if (!parseSeats(seatSpec, myAI, &seatPolicy, seats)) return EXIT_FAILURE;
+    }
+
+    if (!shmName.empty()) {
+        if (trainerConfig.algorithm != LearnerAlgorithm::QLearning) {
+            std::cerr << "Only Q-learning trains on a shared-memory table." << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (myAI.epsilonSchedule.perState() || myAI.alphaSchedule.perState()) {
+            std::cerr << "Visit-based schedules need per-process visit counts; not available with --shm." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Several processes train one table; only the last to leave writes the database
+    auto trainTogether = [&]() -> bool {
+        SharedQTable shared;
+        bool joined = shared.attach(shmName, [&](AtomicQTable& table) {
+            // The creator starts the segment like a single process would start training
+            QTable start;
+            if (trainMode != 0) store.load(start);
+            table.loadFrom(start);
+        });
+        if (!joined) return false;
+        std::cout << (shared.created() ? "Created" : "Joined") << " shared Q-table " << shmName << " as process "
+                  << shared.memberSlot() << (shared.leads() ? " (leader)" : "") << std::endl;
+        {
+            // Every process gets one, since any may become the leader when the one before it
+            // leaves. The leader's snapshots hold the whole segment, which replaces whatever the file had.
+            std::unique_ptr<QTableCheckpointer> checkpointer;
+            if (trainerConfig.checkpointInterval > 0) {
+                checkpointer.reset(new QTableCheckpointer(store, true));
+                trainerConfig.checkpointer = checkpointer.get();
+            }
+            runSharedMemoryTrainer(myAI, trainHands, trainerConfig, shared);
+            trainerConfig.checkpointer = nullptr;
+            if (checkpointer) {
+                if (!checkpointer->flush(myAI.qTable)) {
+                    std::cerr << "The last checkpoint could not be written; the last process to leave saves every state."
+                              << std::endl;
+                }
+                // Only the processes that led at some point wrote any
+                if (checkpointer->checkpointsWritten() + checkpointer->failures() > 0) {
+                    std::cout << "Checkpoints written: " << checkpointer->checkpointsWritten() << ", failed: "
+                              << checkpointer->failures() << std::endl;
+                }
+            }
+        }
+        if (!shared.detach()) {
+            std::cout << "Left shared Q-table " << shmName << "; the last process to leave saves it." << std::endl;
+            return true;
+        }
+        // Last out: whatever the others learned after this process finished is in the segment too
+        shared.table().storeTo(myAI.qTable);
+        if (!store.replace(myAI.qTable)) return false;
+        shared.remove();
+        std::cout << "Last to leave shared Q-table " << shmName << ": AI knowledge saved to " << dbFile << std::endl;
+        return true;
+    };
+
+    auto train = [&]() {
+        if (!shmName.empty()) return trainTogether();
+        // A new model replaces the saved one at its first checkpoint, or at the end; until then
+        // the file keeps the previous model, so an interrupted run loses nothing that was saved
+        {
+            std::unique_ptr<QTableCheckpointer> checkpointer;
+            if (trainerConfig.checkpointInterval > 0) {
+                checkpointer.reset(new QTableCheckpointer(store, true));
+                trainerConfig.checkpointer = checkpointer.get();
+            }
+            if (myAI.epsilonSchedule.kind != ScheduleKind::Constant) {
+                std::cout << "Epsilon: " << myAI.epsilonSchedule.describe() << std::endl;
+            }
+            if (myAI.alphaSchedule.kind != ScheduleKind::Constant) {
+                std::cout << "Alpha: " << myAI.alphaSchedule.describe() << std::endl;
+            }
+            if (!seats.empty()) {
+                if (trainerConfig.algorithm != LearnerAlgorithm::QLearning || trainerConfig.replayCapacity > 0 ||
+                    trainerConfig.threads > 1) {
+                    std::cout << "Table seats learn with Q-learning on one thread; other trainer options are ignored."
+                              << std::endl;
+                }
+                std::cout << "Training AI at a table of " << seats.size() << " seats for " << trainHands
+                          << " learner episodes..." << std::endl;
+                printTableStats(std::cout, seats, runTableTrainer(seats, trainHands, trainerConfig));
+            } else if (trainerConfig.threads > 1) {
+                runParallelTrainer(myAI, trainHands, trainerConfig);
+            } else {
+                runSilentTrainer(myAI, trainHands, trainerConfig);
+            }
+            trainerConfig.checkpointer = nullptr;
+            if (checkpointer) {
+                if (!checkpointer->flush(myAI.qTable)) {
+                    std::cerr << "The last checkpoint could not be written; the final save retries it." << std::endl;
+                }
+                std::cout << "Checkpoints written: " << checkpointer->checkpointsWritten() << ", failed: "
+                          << checkpointer->failures() << std::endl;
+            }
+        }
+        if (!store.replace(myAI.qTable)) {
+            std::cerr << "Could not save AI knowledge to " << dbFile << std::endl;
+            return false;
+        }
+        std::cout << "AI knowledge saved to " << dbFile << std::endl;
+        return true;
+    };
 
     // Handle Training/Loading
-    if (trainMode == 0) {
+    if (mappedTable) {
+        std::cout << "--- [MODE: PLAYING " << tableFile << "] ---" << std::endl;
+        myAI.qTable = *policy; // QLearner owns its table; this is a memcpy, not a parse
+    } else if (trainMode == 0) {
         std::cout << "--- [MODE: TRAINING AI] ---" << std::endl;
-        runSilentTrainer(myAI, 250000); 
-        myAI.saveToDatabase(dbFile);
+        if (!train()) return EXIT_FAILURE;
     } else {
-        myAI.loadFromDatabase(dbFile);
-        if (myAI.qTable.empty()) {
+        if (store.load(myAI.qTable)) {
+            std::cout << "AI knowledge loaded. States known: " << myAI.qTable.size() << std::endl;
+        }
+        if (!shmName.empty()) {
+            // A shared table always trains; from the database if this process creates it
+            std::cout << "--- [MODE: CONTINUING TRAINING ON " << shmName << "] ---" << std::endl;
+            if (!train()) return EXIT_FAILURE;
+        } else if (myAI.qTable.empty()) {
             std::cout << "--- [MODE: DATABASE EMPTY - TRAINING] ---" << std::endl;
-            runSilentTrainer(myAI, 250000);
-            myAI.saveToDatabase(dbFile);
+            if (!train()) return EXIT_FAILURE;
         }
     }
 
     // Initialize GUI if requested
     Renderer* gui = nullptr;
     if (guiMode == 1) {
-        gui = new Renderer(); 
+#ifdef BLACKJACK_GUI
+        gui = new Renderer();
+        if (guiFps > 0) {
+            gui->setFrameBudget(1000 / guiFps);
+            gui->setAutoAdvance(playMode == 1); // Unattended AI playback; press N to stop
+        }
+#else
+        std::cerr << "This build has no GUI (use BlackjackAI, built with OpenCV); playing in the console." << std::endl;
+#endif
     }
 
     // Game Loop
+    Shoe shoe(trainerConfig.decks, trainerConfig.penetration, false, streamRng(STREAM_PLAY_SHOE));
+    if (history) history->beginSession(HistorySource::Play, getMasterSeed(), trainerConfig.decks, trainerConfig.rules);
     char playAgain = 'y';
     while (playAgain == 'y') {
-        playRound(myAI, playMode, gui);
+        dispatchRules(trainerConfig.rules, [&](auto rules) {
+            playRound<decltype(rules)>(myAI, shoe, playMode, gui, history.get());
+        });
         
         if (gui) {
             int key = gui->getKeyPressed();
@@ -222,11 +792,18 @@ int main(int argc, char* argv[]) {
             gui->resetKeyPressed();
         } else {
             std::cout << "\nPlay another round? (y/n): ";
-            std::cin >> playAgain;
+            // End of input ends the session rather than replaying the last answer forever
+            if (!(std::cin >> playAgain)) {
+                std::cout << std::endl;
+                break;
+            }
         }
     }
 
     if (gui) delete gui;
+    if (history && history->flush()) {
+        std::cout << history->handsWritten() << " hands logged to " << historyFile << std::endl;
+    }
     std::cout << "Thanks for playing!" << std::endl;
     
     return EXIT_SUCCESS;
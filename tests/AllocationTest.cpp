@@ -0,0 +1,95 @@
+// Proves the training hand loop never allocates: global operator new counts
+// every allocation, and after a warm-up the shoe/hand loop and the trainer
+// must play their hands without one. Exits non-zero if any hand allocated.
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "Hand.h"
+#include "QLearner.h"
+#include "Shoe.h"
+#include "Trainer.h"
+
+namespace {
+
+std::atomic<long long> allocations{0};
+
+void* countedAlloc(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) return p;
+    throw std::bad_alloc();
+}
+
+// Deals and settles `hands` hands the way the trainer does, without a learner
+long long playShoeHands(Shoe& shoe, long long hands) {
+    long long total = 0;
+    for (long long i = 0; i < hands; ++i) {
+        shoe.prepareRound();
+        Hand player, dealer;
+        player.addCard(shoe.dealCard());
+        dealer.addCard(shoe.dealCard());
+        player.addCard(shoe.dealCard());
+        dealer.addCard(shoe.dealCard());
+        while (player.getTotal() < 17) player.addCard(shoe.dealCard());
+        while (!player.isBust() && dealer.getTotal() < 17) dealer.addCard(shoe.dealCard());
+        total += player.getTotal() + dealer.getTotal() + (player.isSoft() ? 1 : 0);
+    }
+    return total;
+}
+
+bool report(const char* what, long long hands, long long count) {
+    std::cout << what << ": " << count << " allocations over " << hands << " hands" << std::endl;
+    return count == 0;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+int main(int argc, char* argv[]) {
+    long long hands = (argc > 1) ? static_cast<long long>(std::stod(argv[1])) : 200000;
+    bool ok = true;
+
+    // Shoe and Hand alone, through several reshuffles
+    Shoe shoe(6, 0.75, false, streamRng(STREAM_TRAINER));
+    long long checksum = playShoeHands(shoe, 1000);
+    long long before = allocations.load();
+    checksum += playShoeHands(shoe, hands);
+    ok = report("Shoe and Hand", hands, allocations.load() - before) && ok;
+
+    // The trainer's hand loop (playTrainingHand and the Q-learning update). Each run
+    // makes a fixed number of set-up allocations, so a longer run must make no more
+    // than a shorter one.
+    TrainerConfig quiet;
+    quiet.log = nullptr;
+    QLearner ai;
+    runSilentTrainer(ai, 10000, quiet); // Warm-up: every state the loop will touch exists
+    before = allocations.load();
+    runSilentTrainer(ai, 1000, quiet);
+    long long shortRun = allocations.load() - before;
+    before = allocations.load();
+    runSilentTrainer(ai, hands + 1000, quiet);
+    long long longRun = allocations.load() - before;
+    ok = report("Trainer hand loop", hands, longRun - shortRun) && ok;
+
+    std::cout << (ok ? "PASS" : "FAIL") << " (checksum " << checksum << ")" << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
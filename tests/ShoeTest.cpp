@@ -0,0 +1,71 @@
+// Checks a round that runs a shoe out: a single-deck shoe is dealt down to
+// exactly its reserve, and the next round then takes more cards than are left,
+// so the shoe reshuffles its discards mid-round. No card still on the table may
+// be dealt again, and the running and true counts must stay those of the cards
+// dealt since the last shuffle. Runs with both shuffle modes and several
+// seeds. Exits non-zero on any failure.
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "Random.h"
+#include "Shoe.h"
+
+namespace {
+
+constexpr int DECK = 52;
+constexpr int ROUND_CARDS = 30; // Well past the 12 cards left when the round starts
+
+// Failures for one shoe
+int playPastTheEnd(bool lazyShuffle, uint64_t seed) {
+    Shoe shoe(1, 1.0, lazyShuffle, Rng(seed));
+    int reserve = Shoe::RESERVE_PER_HAND * 2;
+    int failures = 0;
+    auto check = [&](bool ok, const char* what, int card) {
+        if (ok) return;
+        if (++failures <= 5) {
+            std::cout << "  " << (lazyShuffle ? "lazy" : "shuffled") << " shoe, seed " << seed << ", round card "
+                      << card << ": " << what << std::endl;
+        }
+    };
+
+    // Earlier rounds leave exactly the reserve, so the next round starts without a reshuffle
+    shoe.prepareRound();
+    int before = 0;
+    for (int i = 0; i < DECK - reserve; ++i) before += shoe.dealCard().getHiLo();
+    check(!shoe.prepareRound(), "reshuffled with the reserve still in the shoe", 0);
+
+    std::vector<bool> onTable(DECK, false);
+    int round = 0;
+    for (int i = 1; i <= ROUND_CARDS; ++i) {
+        Card card = shoe.dealCard();
+        check(!onTable[card.getId()], "dealt a card that is still on the table", i);
+        onTable[card.getId()] = true;
+        round += card.getHiLo();
+
+        // Until the shoe runs out the count covers the whole shoe; after it, only this round's cards
+        bool wrapped = i > reserve;
+        int expected = wrapped ? round : before + round;
+        int remaining = wrapped ? DECK - i : reserve - i;
+        check(shoe.getRunningCount() == expected, "running count differs from the cards dealt since the shuffle", i);
+        check(shoe.cardsRemaining() == remaining, "wrong number of cards remaining", i);
+        check(shoe.getTrueCount() == expected * 52.0 / std::max(remaining, 26), "true count differs", i);
+    }
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    for (bool lazyShuffle : {false, true}) {
+        int failures = 0;
+        for (uint64_t seed = 1; seed <= 200; ++seed) failures += playPastTheEnd(lazyShuffle, seed);
+        std::cout << (lazyShuffle ? "lazy shuffle" : "up-front shuffle") << ": " << failures
+                  << " failed checks over 200 shoes" << std::endl;
+        ok = ok && failures == 0;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+// Checks that TileCoder's AVX2 and scalar kernels agree exactly: for every
+// CountState, tiles() must pick the same cells and values() must return the
+// same bits with setUseAvx2(true) and setUseAvx2(false). Weights are random,
+// with mixed signs and magnitudes, so any change in summation order shows up.
+// Exits 77 (skipped) on CPUs without AVX2 and non-zero on any mismatch.
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "CountQTable.h"
+#include "QTable.h"
+#include "Random.h"
+#include "TileLearner.h"
+
+namespace {
+
+constexpr int SKIPPED = 77;
+
+std::vector<float> randomWeights(const TileCoder& coder, Rng& rng) {
+    std::vector<float> weights(coder.weightCount() * 2);
+    for (float& w : weights) {
+        double magnitude = rng.below(3) == 0 ? 1e-4 : rng.below(2) == 0 ? 1.0 : 100.0;
+        w = static_cast<float>((rng.uniform() * 2 - 1) * magnitude);
+    }
+    return weights;
+}
+
+// Mismatching states for one table size
+long long compareKernels(int bits, Rng& rng) {
+    TileCoder avx2(bits);
+    TileCoder scalar(bits);
+    avx2.setUseAvx2(true);
+    scalar.setUseAvx2(false);
+    std::vector<float> weights = randomWeights(avx2, rng);
+
+    long long mismatches = 0;
+    for (int i = 0; i < CountQTable::STATES; ++i) {
+        State basic = QTable::stateAt(i % CountQTable::STATES_PER_BUCKET);
+        CountState s = {basic.pTotal, basic.dCard, basic.hasAce, i / CountQTable::STATES_PER_BUCKET};
+        uint32_t avx2Tiles[TileCoder::TILINGS], scalarTiles[TileCoder::TILINGS];
+        avx2.tiles(s, avx2Tiles);
+        scalar.tiles(s, scalarTiles);
+        double avx2Q[2], scalarQ[2];
+        avx2.values(weights.data(), avx2Tiles, avx2Q);
+        scalar.values(weights.data(), scalarTiles, scalarQ);
+
+        bool sameTiles = std::memcmp(avx2Tiles, scalarTiles, sizeof(avx2Tiles)) == 0;
+        bool sameValues = std::memcmp(avx2Q, scalarQ, sizeof(avx2Q)) == 0;
+        if (sameTiles && sameValues) continue;
+        if (++mismatches <= 5) {
+            std::cout << "  bits " << bits << ", state (" << s.pTotal << ", " << s.dCard << ", "
+                      << (s.soft ? "soft" : "hard") << ", count " << CountQTable::countOf(s.countBucket) << "): "
+                      << (sameTiles ? "" : "tiles differ ") << (sameValues ? "" : "values differ") << std::endl;
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main() {
+    TileCoder probe;
+    probe.setUseAvx2(true);
+    if (!probe.usingAvx2()) {
+        std::cout << "SKIP: no AVX2 kernel on this CPU or build" << std::endl;
+        return SKIPPED;
+    }
+
+    Rng rng(20240601);
+    bool ok = true;
+    for (int bits : {1, 8, 12, 16, 24}) {
+        long long mismatches = compareKernels(bits, rng);
+        std::cout << "bits " << bits << ": " << mismatches << " of " << CountQTable::STATES
+                  << " states differ between the AVX2 and scalar kernels" << std::endl;
+        ok = ok && mismatches == 0;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
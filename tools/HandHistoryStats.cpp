@@ -0,0 +1,21 @@
+// Scans a hand-history log written with --history and prints aggregate stats.
+//
+//   hand_history blackjack_hands.bjh
+//
+// The log is memory-mapped and decoded one hand at a time, so files of any
+// size are scanned in constant memory.
+#include <iostream>
+#include "HandHistory.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <history-file>" << std::endl;
+        return 2;
+    }
+
+    HandHistoryReader reader(argv[1]);
+    if (!reader.isOpen()) return 1;
+    HandHistoryStats stats = scanHandHistory(reader);
+    printHandHistoryStats(std::cout, stats);
+    return stats.truncated ? 1 : 0;
+}
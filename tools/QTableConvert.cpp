@@ -0,0 +1,54 @@
+// Converts Q-tables between the SQLite database and the binary mappable format.
+//
+//   qtable_convert blackjack_brain.db blackjack_brain.bqt   # SQLite -> binary
+//   qtable_convert blackjack_brain.bqt restored.db          # binary -> SQLite
+//
+// The direction follows the input's extension (.db means SQLite). Values are
+// copied as raw doubles both ways, so a round trip is bit-exact.
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "QTableFile.h"
+#include "QTableStore.h"
+
+namespace {
+
+bool isDatabase(const std::string& path) {
+    return path.size() >= 3 && path.compare(path.size() - 3, 3, ".db") == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.db|input.bqt> <output>" << std::endl;
+        return 2;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+
+    QTable table;
+    if (isDatabase(input)) {
+        // Opening a missing file with SQLite would create it and load as an empty table
+        if (!std::ifstream(input)) {
+            std::cerr << "Could not open " << input << std::endl;
+            return 1;
+        }
+        QTableStore store(input);
+        if (!store.load(table)) return 1;
+        if (table.empty()) {
+            std::cerr << input << " holds no Q-table" << std::endl;
+            return 1;
+        }
+        if (!writeQTableFile(output, table)) return 1;
+    } else {
+        MappedQTable mapped(input);
+        if (!mapped.isOpen()) return 1;
+        table = mapped.table();
+        QTableStore store(output);
+        if (!store.replace(table)) return 1;
+    }
+
+    std::cout << "Converted " << table.size() << " states from " << input << " to " << output << std::endl;
+    return 0;
+}